@@ -1,13 +1,33 @@
 #pragma once
 
 #include "common.hpp"
+#include "buffer_arena.hpp"
+#include "buffer_layout.hpp"
 #include "data_buffer.hpp"
+#include "dirty_regions.hpp"
+#include "fence.hpp"
+#include "frame_context.hpp"
 #include "framebuffer.hpp"
 #include "fullscreen_pass.hpp"
 #include "compute_pass.hpp"
+#include "mip_pyramid.hpp"
+#include "msaa_resolve.hpp"
+#include "readback.hpp"
 #include "render_pass.hpp"
+#include "resource_registry.hpp"
+#include "sampler.hpp"
 #include "shader_interop.hpp"
 #include "shader_pipeline.hpp"
 #include "shader_program.hpp"
+#include "streaming_buffer.hpp"
+#include "structured_buffer.hpp"
 #include "texture.hpp"
+#include "texture_file.hpp"
+#include "texture_loader.hpp"
+#include "texture_pool.hpp"
+#include "texture_streamer.hpp"
+#include "texture_table.hpp"
+#include "typed_texture.hpp"
+#include "upload_batch.hpp"
 #include "vertex_array.hpp"
+#include "virtual_texture.hpp"
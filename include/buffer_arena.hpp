@@ -0,0 +1,84 @@
+#pragma once
+
+#include "common.hpp"
+#include "data_buffer.hpp"
+
+namespace baldr {
+
+struct buffer_allocation
+{
+    std::shared_ptr<data_buffer> buffer = nullptr;
+    GLintptr offset = 0;
+    GLsizeiptr byte_count = 0;
+    GLuint block = 0;
+
+    explicit operator bool() const;
+
+    // index of the first value of type T (e.g. first index or base vertex)
+    template <typename T>
+    GLuint
+    first() const;
+
+    template <typename T>
+    GLuint
+    value_count() const;
+};
+
+// Suballocates many small ranges (vertex/index data, uniform or storage
+// blocks) from a few large data_buffers using a coalescing first-fit free
+// list per block.
+class buffer_arena
+{
+public:
+    buffer_arena(GLsizeiptr block_byte_count, immutable_storage storage = immutable_storage());
+
+    buffer_arena(const buffer_arena& other) = delete;
+
+    virtual ~buffer_arena();
+
+    buffer_arena&
+    operator=(const buffer_arena& other) = delete;
+
+    // alignment does not need to be a power of two so that vertex data can be
+    // aligned to its stride; 0 uses data_buffer::offset_alignment()
+    [[nodiscard]]
+    buffer_allocation
+    allocate(GLsizeiptr byte_count, GLuint alignment = 0);
+
+    template <typename T>
+    [[nodiscard]]
+    buffer_allocation
+    allocate(const std::vector<T>& data, GLuint alignment = sizeof(T));
+
+    void
+    free(const buffer_allocation& allocation);
+
+    GLuint
+    block_count() const;
+
+    GLsizeiptr
+    allocated_bytes() const;
+
+    GLsizeiptr
+    reserved_bytes() const;
+
+protected:
+    struct block
+    {
+        std::shared_ptr<data_buffer> buffer;
+        std::map<GLintptr, GLsizeiptr> free_ranges;
+    };
+
+    std::optional<buffer_allocation>
+    allocate_from_(GLuint block_index, GLsizeiptr byte_count, GLuint alignment);
+
+protected:
+    GLsizeiptr block_byte_count_;
+    immutable_storage storage_;
+    GLsizeiptr allocated_bytes_;
+    std::vector<block> blocks_;
+};
+
+}  // namespace baldr
+
+#include "buffer_arena.ipp"
@@ -0,0 +1,29 @@
+namespace baldr {
+
+inline
+buffer_allocation::operator bool() const {
+    return buffer != nullptr;
+}
+
+template <typename T>
+inline GLuint
+buffer_allocation::first() const {
+    terminate_unless(offset % sizeof(T) == 0, "Allocation offset {} is not aligned to value size {}", offset, sizeof(T));
+    return static_cast<GLuint>(offset / sizeof(T));
+}
+
+template <typename T>
+inline GLuint
+buffer_allocation::value_count() const {
+    return static_cast<GLuint>(byte_count / sizeof(T));
+}
+
+template <typename T>
+inline buffer_allocation
+buffer_arena::allocate(const std::vector<T>& data, GLuint alignment) {
+    buffer_allocation allocation = allocate(data.size() * sizeof(T), alignment);
+    allocation.buffer->set_data(reinterpret_cast<const void*>(data.data()), allocation.offset, allocation.byte_count);
+    return allocation;
+}
+
+}  // namespace baldr
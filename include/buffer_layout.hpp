@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstring>
+
+#include "common.hpp"
+
+namespace baldr {
+
+enum class layout_rules : int {
+    std140,
+    std430
+};
+
+namespace detail {
+
+// alignment/size rules for scalars, Eigen vectors/matrices, std::array and
+// nested layout_struct members
+template <layout_rules Rules, typename T, typename Enable = void>
+struct layout_traits;
+
+}  // namespace detail
+
+// CPU-side block laid out according to std140 (uniform blocks) or std430
+// (shader storage blocks) with member offsets computed at compile time, e.g.
+//   std140_struct<mat4f_t, mat4f_t, vec3f_t, float> camera;
+//   camera.set<2>(position);
+//   ubo.set_data(camera.data());
+template <layout_rules Rules, typename... Ts>
+class layout_struct
+{
+public:
+    static constexpr size_t member_count = sizeof...(Ts);
+
+    static constexpr std::array<size_t, sizeof...(Ts)>
+    offsets();
+
+    static constexpr size_t
+    alignment();
+
+    static constexpr size_t
+    byte_count();
+
+    layout_struct();
+
+    explicit layout_struct(const Ts&... values);
+
+    template <size_t I>
+    void
+    set(const std::tuple_element_t<I, std::tuple<Ts...>>& value);
+
+    const std::byte*
+    data() const;
+
+    std::byte*
+    data();
+
+protected:
+    std::array<std::byte, byte_count()> data_;
+};
+
+template <typename... Ts>
+using std140_struct = layout_struct<layout_rules::std140, Ts...>;
+
+template <typename... Ts>
+using std430_struct = layout_struct<layout_rules::std430, Ts...>;
+
+}  // namespace baldr
+
+#include "buffer_layout.ipp"
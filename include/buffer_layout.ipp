@@ -0,0 +1,158 @@
+namespace baldr {
+
+namespace detail {
+
+constexpr size_t
+align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// std140 rounds array strides and struct alignments up to vec4, std430 does not
+template <layout_rules Rules>
+constexpr size_t
+aggregate_alignment(size_t alignment) {
+    return Rules == layout_rules::std140 ? align_up(alignment, 16) : alignment;
+}
+
+template <layout_rules Rules, typename T>
+struct layout_traits<Rules, T, std::enable_if_t<std::is_arithmetic_v<T>>>
+{
+    // bools are 32 bit in GLSL
+    using stored_t = std::conditional_t<std::is_same_v<T, bool>, uint32_t, T>;
+
+    static constexpr size_t alignment = sizeof(stored_t);
+    static constexpr size_t size = sizeof(stored_t);
+
+    static void
+    write(std::byte* dst, const T& value) {
+        stored_t stored = static_cast<stored_t>(value);
+        memcpy(dst, &stored, sizeof(stored_t));
+    }
+};
+
+template <layout_rules Rules, typename S, int Rows, int Cols, int Options, int MaxRows, int MaxCols>
+struct layout_traits<Rules, Eigen::Matrix<S, Rows, Cols, Options, MaxRows, MaxCols>>
+{
+    static_assert(Rows > 0 && Cols > 0, "Buffer layouts require fixed size Eigen types");
+    static_assert(std::is_same_v<S, float> || std::is_same_v<S, double> || std::is_same_v<S, int32_t> || std::is_same_v<S, uint32_t>, "Unsupported buffer layout component type");
+
+    static constexpr bool is_vector = Rows == 1 || Cols == 1;
+    static constexpr size_t components = is_vector ? std::max(Rows, Cols) : Rows;
+    static_assert(components <= 4 && (is_vector || Cols <= 4), "Buffer layout vectors/matrices are limited to 4 components");
+
+    // vec3 is aligned like vec4, matrices are laid out as arrays of column vectors
+    static constexpr size_t vector_alignment = (components == 2 ? 2 : 4) * sizeof(S);
+    static constexpr size_t column_stride = aggregate_alignment<Rules>(vector_alignment);
+
+    static constexpr size_t alignment = is_vector ? vector_alignment : column_stride;
+    static constexpr size_t size = is_vector ? components * sizeof(S) : Cols * column_stride;
+
+    static void
+    write(std::byte* dst, const Eigen::Matrix<S, Rows, Cols, Options, MaxRows, MaxCols>& value) {
+        if constexpr (is_vector) {
+            for (size_t i = 0; i < components; ++i) {
+                memcpy(dst + i * sizeof(S), &value.coeffRef(i), sizeof(S));
+            }
+        } else {
+            for (int c = 0; c < Cols; ++c) {
+                for (int r = 0; r < Rows; ++r) {
+                    memcpy(dst + c * column_stride + r * sizeof(S), &value.coeffRef(r, c), sizeof(S));
+                }
+            }
+        }
+    }
+};
+
+template <layout_rules Rules, typename T, size_t N>
+struct layout_traits<Rules, std::array<T, N>>
+{
+    static constexpr size_t alignment = aggregate_alignment<Rules>(layout_traits<Rules, T>::alignment);
+    static constexpr size_t stride = align_up(layout_traits<Rules, T>::size, alignment);
+    static constexpr size_t size = N * stride;
+
+    static void
+    write(std::byte* dst, const std::array<T, N>& value) {
+        for (size_t i = 0; i < N; ++i) {
+            layout_traits<Rules, T>::write(dst + i * stride, value[i]);
+        }
+    }
+};
+
+template <layout_rules Rules, layout_rules NestedRules, typename... Ts>
+struct layout_traits<Rules, layout_struct<NestedRules, Ts...>>
+{
+    static_assert(Rules == NestedRules, "Nested layout_struct must use the same layout rules");
+
+    static constexpr size_t alignment = layout_struct<NestedRules, Ts...>::alignment();
+    static constexpr size_t size = layout_struct<NestedRules, Ts...>::byte_count();
+
+    static void
+    write(std::byte* dst, const layout_struct<NestedRules, Ts...>& value) {
+        memcpy(dst, value.data(), size);
+    }
+};
+
+}  // namespace detail
+
+template <layout_rules Rules, typename... Ts>
+constexpr std::array<size_t, sizeof...(Ts)>
+layout_struct<Rules, Ts...>::offsets() {
+    std::array<size_t, sizeof...(Ts)> result{};
+    size_t offset = 0, index = 0;
+    ((offset = detail::align_up(offset, detail::layout_traits<Rules, Ts>::alignment),
+      result[index++] = offset,
+      offset += detail::layout_traits<Rules, Ts>::size), ...);
+    return result;
+}
+
+template <layout_rules Rules, typename... Ts>
+constexpr size_t
+layout_struct<Rules, Ts...>::alignment() {
+    return detail::aggregate_alignment<Rules>(std::max({size_t(1), detail::layout_traits<Rules, Ts>::alignment...}));
+}
+
+template <layout_rules Rules, typename... Ts>
+constexpr size_t
+layout_struct<Rules, Ts...>::byte_count() {
+    if constexpr (sizeof...(Ts) == 0) {
+        return 0;
+    } else {
+        constexpr size_t sizes[] = {detail::layout_traits<Rules, Ts>::size...};
+        return detail::align_up(offsets().back() + sizes[sizeof...(Ts) - 1], alignment());
+    }
+}
+
+template <layout_rules Rules, typename... Ts>
+inline
+layout_struct<Rules, Ts...>::layout_struct() : data_{} {
+}
+
+template <layout_rules Rules, typename... Ts>
+inline
+layout_struct<Rules, Ts...>::layout_struct(const Ts&... values) : data_{} {
+    [&]<size_t... Is>(std::index_sequence<Is...>) {
+        (set<Is>(values), ...);
+    }(std::index_sequence_for<Ts...>{});
+}
+
+template <layout_rules Rules, typename... Ts>
+template <size_t I>
+inline void
+layout_struct<Rules, Ts...>::set(const std::tuple_element_t<I, std::tuple<Ts...>>& value) {
+    using member_t = std::tuple_element_t<I, std::tuple<Ts...>>;
+    detail::layout_traits<Rules, member_t>::write(data_.data() + offsets()[I], value);
+}
+
+template <layout_rules Rules, typename... Ts>
+inline const std::byte*
+layout_struct<Rules, Ts...>::data() const {
+    return data_.data();
+}
+
+template <layout_rules Rules, typename... Ts>
+inline std::byte*
+layout_struct<Rules, Ts...>::data() {
+    return data_.data();
+}
+
+}  // namespace baldr
@@ -11,6 +11,8 @@
 #include <variant>
 #include <algorithm>
 #include <filesystem>
+#include <limits>
+#include <span>
 
 #include <Eigen/Dense>
 
@@ -90,7 +92,7 @@ perror(const char *format, const Args &... args)
 }
 
 template <typename... Args>
-inline void
+[[noreturn]] inline void
 fail(const char *format, const Args &... args)
 {
     perror(format, args...);
@@ -1,27 +1,124 @@
 #pragma once
 
 #include "common.hpp"
+#include "readback.hpp"
+#include "resource_registry.hpp"
 
 namespace baldr {
 
+struct immutable_storage
+{
+    immutable_storage(GLbitfield f = GL_DYNAMIC_STORAGE_BIT) : flags(f) {}
+    GLbitfield flags;
+};
+
+class data_buffer;
+
+// RAII mapping of a typed buffer range; the buffer is unmapped on destruction
+template <typename T>
+class mapped_view
+{
+public:
+    mapped_view(const data_buffer& buffer, T* values, size_t count);
+
+    mapped_view(const mapped_view& other) = delete;
+
+    mapped_view(mapped_view&& other) noexcept;
+
+    virtual ~mapped_view();
+
+    mapped_view&
+    operator=(const mapped_view& other) = delete;
+
+    std::span<T>
+    span() const;
+
+    operator std::span<T>() const;
+
+    T*
+    data() const;
+
+    size_t
+    size() const;
+
+    T&
+    operator[](size_t index) const;
+
+    auto
+    begin() const;
+
+    auto
+    end() const;
+
+protected:
+    const data_buffer* buffer_;
+    std::span<T> values_;
+};
+
 class data_buffer
 {
 public:
     data_buffer(GLuint byte_count, GLenum usage_hint, const void* data = nullptr);
 
+    // allocates immutable storage (glNamedBufferStorage) with the given flags
+    data_buffer(GLuint byte_count, immutable_storage storage, const void* data = nullptr);
+
     template <typename T>
     data_buffer(const std::vector<T>& data, GLenum usage_hint);
 
     template <typename Derived>
     data_buffer(const Eigen::PlainObjectBase<Derived>& dense_array, GLenum usage_hint);
 
+    template <typename T>
+    data_buffer(const std::vector<T>& data, immutable_storage storage);
+
+    template <typename Derived>
+    data_buffer(const Eigen::PlainObjectBase<Derived>& dense_array, immutable_storage storage);
+
     virtual ~data_buffer();
 
+    // offset alignment satisfying both uniform and shader storage range bindings
+    static GLuint
+    offset_alignment();
+
     GLuint handle() const;
 
     GLuint
     byte_count() const;
 
+    GLuint
+    capacity() const;
+
+    // grows the underlying storage to at least byte_count bytes; existing
+    // contents are moved on the GPU. Since this creates a new buffer object
+    // the handle changes and bindings have to be re-established.
+    void
+    reserve(GLuint byte_count);
+
+    // changes the size, growing the capacity geometrically if required
+    void
+    resize(GLuint byte_count);
+
+    void
+    append(const void* data, GLuint byte_count);
+
+    template <typename T>
+    void
+    append(const std::vector<T>& data);
+
+    template <typename T>
+    void
+    append(std::span<const T> data);
+
+    void
+    shrink_to_fit();
+
+    bool
+    immutable() const;
+
+    GLbitfield
+    storage_flags() const;
+
     template <typename T>
     uint32_t
     value_count() const;
@@ -33,33 +130,93 @@ public:
     void
     set_data(const std::vector<T>& data);
 
+    void
+    set_data(const void* data, GLintptr offset, GLsizeiptr byte_count);
+
+    // uploads data.size() values starting at value index first
+    template <typename T>
+    void
+    set_data(std::span<const T> data, GLuint first = 0);
+
     void
     get_data(void* data) const;
 
     void
     get_data(void* data, GLuint byte_count) const;
 
+    void
+    get_data(void* data, GLintptr offset, GLsizeiptr byte_count) const;
+
     template <typename T>
     void
     get_data(std::vector<T>& data) const;
 
+    // downloads data.size() values starting at value index first
+    template <typename T>
+    void
+    get_data(std::span<T> data, GLuint first = 0) const;
+
+    // copies the range into a pooled staging buffer and fences the copy;
+    // the returned handle can be polled instead of stalling on a read mapping
+    [[nodiscard]]
+    readback
+    read_async(GLintptr offset, GLsizeiptr byte_count) const;
+
+    [[nodiscard]]
+    readback
+    read_async() const;
+
     void*
     map(GLbitfield access);
 
     const void*
     map(GLbitfield access) const;
 
+    // access may contain GL_MAP_INVALIDATE_RANGE_BIT, GL_MAP_UNSYNCHRONIZED_BIT etc.
+    void*
+    map(GLbitfield access, GLintptr offset, GLsizeiptr byte_count);
+
+    const void*
+    map(GLbitfield access, GLintptr offset, GLsizeiptr byte_count) const;
+
     void
     unmap() const;
 
+    // maps count values starting at value index first (count = 0 maps up to
+    // the end of the buffer) for in-place access without an intermediate copy
+    template <typename T>
+    [[nodiscard]]
+    mapped_view<T>
+    view(GLbitfield access, GLuint first = 0, GLuint count = 0);
+
+    template <typename T>
+    [[nodiscard]]
+    mapped_view<const T>
+    view(GLbitfield access = GL_MAP_READ_BIT, GLuint first = 0, GLuint count = 0) const;
+
     void
     clear_to_zero();
 
+    void
+    clear_to_zero(GLintptr offset, GLsizeiptr byte_count);
+
+    // groups the buffer in the resource_registry statistics
+    void
+    tag(const std::string& tag);
+
+protected:
+    void
+    reallocate_(GLuint capacity);
+
 protected:
     bool allocated_;
+    bool immutable_;
     GLuint byte_count_;
+    GLuint capacity_;
     GLenum usage_hint_;
+    GLbitfield storage_flags_;
     GLuint handle_;
+    resource_registry::resource_id resource_id_;
 };
 
 }  // namespace baldr
@@ -1,5 +1,67 @@
 namespace baldr {
 
+template <typename T>
+inline
+mapped_view<T>::mapped_view(const data_buffer& buffer, T* values, size_t count) : buffer_(&buffer), values_(values, count) {
+    terminate_unless(values != nullptr && count, "Unable to map buffer range");
+}
+
+template <typename T>
+inline
+mapped_view<T>::mapped_view(mapped_view&& other) noexcept : buffer_(other.buffer_), values_(other.values_) {
+    other.buffer_ = nullptr;
+}
+
+template <typename T>
+inline
+mapped_view<T>::~mapped_view() {
+    if (buffer_) {
+        buffer_->unmap();
+    }
+}
+
+template <typename T>
+inline std::span<T>
+mapped_view<T>::span() const {
+    return values_;
+}
+
+template <typename T>
+inline
+mapped_view<T>::operator std::span<T>() const {
+    return values_;
+}
+
+template <typename T>
+inline T*
+mapped_view<T>::data() const {
+    return values_.data();
+}
+
+template <typename T>
+inline size_t
+mapped_view<T>::size() const {
+    return values_.size();
+}
+
+template <typename T>
+inline T&
+mapped_view<T>::operator[](size_t index) const {
+    return values_[index];
+}
+
+template <typename T>
+inline auto
+mapped_view<T>::begin() const {
+    return values_.begin();
+}
+
+template <typename T>
+inline auto
+mapped_view<T>::end() const {
+    return values_.end();
+}
+
 template <typename T>
 data_buffer::data_buffer(const std::vector<T>& data, GLenum usage_hint)
     : data_buffer(data.size() * sizeof(T), usage_hint,
@@ -14,12 +76,40 @@ data_buffer::data_buffer(const Eigen::PlainObjectBase<Derived>& data,
                   usage_hint, reinterpret_cast<const void*>(data.data()))
 {}
 
+template <typename T>
+data_buffer::data_buffer(const std::vector<T>& data, immutable_storage storage)
+    : data_buffer(data.size() * sizeof(T), storage,
+                  reinterpret_cast<const void*>(data.data()))
+{}
+
+template <typename Derived>
+data_buffer::data_buffer(const Eigen::PlainObjectBase<Derived>& data,
+                         immutable_storage storage)
+    : data_buffer(data.size() *
+                      sizeof(typename Eigen::PlainObjectBase<Derived>::Scalar),
+                  storage, reinterpret_cast<const void*>(data.data()))
+{}
+
 template <typename T>
 uint32_t
 data_buffer::value_count() const {
     return byte_count_ / sizeof(T);
 }
 
+template <typename T>
+void
+data_buffer::append(const std::vector<T>& data)
+{
+    append(reinterpret_cast<const void*>(data.data()), data.size() * sizeof(T));
+}
+
+template <typename T>
+void
+data_buffer::append(std::span<const T> data)
+{
+    append(reinterpret_cast<const void*>(data.data()), data.size_bytes());
+}
+
 template <typename T>
 void
 data_buffer::set_data(const std::vector<T>& data)
@@ -27,11 +117,50 @@ data_buffer::set_data(const std::vector<T>& data)
     set_data(reinterpret_cast<const void*>(data.data()));
 }
 
+template <typename T>
+void
+data_buffer::set_data(std::span<const T> data, GLuint first)
+{
+    set_data(reinterpret_cast<const void*>(data.data()), first * sizeof(T), data.size_bytes());
+}
+
 template <typename T>
 void
 data_buffer::get_data(std::vector<T>& data) const
 {
-    get_data(reinterpret_cast<void*>(data.data()));
+    data.resize(value_count<T>());
+    get_data(reinterpret_cast<void*>(data.data()), 0, data.size() * sizeof(T));
+}
+
+template <typename T>
+void
+data_buffer::get_data(std::span<T> data, GLuint first) const
+{
+    get_data(reinterpret_cast<void*>(data.data()), first * sizeof(T), data.size_bytes());
+}
+
+template <typename T>
+mapped_view<T>
+data_buffer::view(GLbitfield access, GLuint first, GLuint count)
+{
+    terminate_unless(first < value_count<T>(), "Buffer view starting at value {} is empty (buffer holds {} values)", first, value_count<T>());
+    if (!count) {
+        count = value_count<T>() - first;
+    }
+    T* values = static_cast<T*>(map(access, first * sizeof(T), count * sizeof(T)));
+    return mapped_view<T>(*this, values, count);
+}
+
+template <typename T>
+mapped_view<const T>
+data_buffer::view(GLbitfield access, GLuint first, GLuint count) const
+{
+    terminate_unless(first < value_count<T>(), "Buffer view starting at value {} is empty (buffer holds {} values)", first, value_count<T>());
+    if (!count) {
+        count = value_count<T>() - first;
+    }
+    const T* values = static_cast<const T*>(map(access, first * sizeof(T), count * sizeof(T)));
+    return mapped_view<const T>(*this, values, count);
 }
 
 }  // namespace baldr
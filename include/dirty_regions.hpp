@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common.hpp"
+#include "texture.hpp"
+
+namespace baldr {
+
+// Accumulates modified texture regions, merging overlapping or adjacent
+// ones, so that a frame's worth of small edits to a large texture is
+// uploaded with a few glTextureSubImage* calls sourced from the CPU copy.
+class dirty_regions
+{
+public:
+    void
+    add(const texture_region& region);
+
+    void
+    add(const vec3i_t& offset, const vec3i_t& extent);
+
+    [[nodiscard]]
+    bool
+    empty() const;
+
+    void
+    clear();
+
+    const std::vector<texture_region>&
+    regions() const;
+
+    // number of texels covered by the merged regions
+    size_t
+    texel_count() const;
+
+    // uploads all dirty regions of level from image, the CPU copy of the
+    // whole level, and clears the accumulator
+    template <typename T>
+    void
+    flush(texture& tex, const T* image, int level = 0);
+
+protected:
+    std::vector<texture_region> regions_;
+};
+
+}  // namespace baldr
+
+#include "dirty_regions.ipp"
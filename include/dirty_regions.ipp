@@ -0,0 +1,16 @@
+namespace baldr {
+
+template <typename T>
+inline void
+dirty_regions::flush(texture& tex, const T* image, int level) {
+    vec3i_t size = tex.level_size(level);
+    size_t channels = tex.channel_count();
+    for (const auto& region : regions_) {
+        const auto& offset = region.offset;
+        size_t first = (static_cast<size_t>(offset[2]) * size[1] + offset[1]) * size[0] + offset[0];
+        tex.set(image + first * channels, region, level, size[0], size[1]);
+    }
+    clear();
+}
+
+}  // namespace baldr
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common.hpp"
+
+namespace baldr {
+
+class fence
+{
+public:
+    // inserts a new fence sync object into the command stream
+    fence();
+
+    fence(const fence& other) = delete;
+
+    fence(fence&& other) noexcept;
+
+    virtual ~fence();
+
+    fence&
+    operator=(const fence& other) = delete;
+
+    fence&
+    operator=(fence&& other) noexcept;
+
+    GLsync
+    handle() const;
+
+    [[nodiscard]]
+    bool
+    signaled() const;
+
+    // blocks the calling thread until the fence is signaled or the timeout
+    // (in nanoseconds) expired; returns whether the fence has been signaled
+    bool
+    wait(GLuint64 timeout = std::numeric_limits<GLuint64>::max()) const;
+
+    // makes the server wait for the fence without blocking the client
+    void
+    wait_server() const;
+
+protected:
+    GLsync handle_;
+};
+
+}  // namespace baldr
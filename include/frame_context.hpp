@@ -0,0 +1,96 @@
+#pragma once
+
+#include "common.hpp"
+#include "fence.hpp"
+
+namespace baldr {
+
+class frame_context;
+
+// N instances of a resource, current() selects the one belonging to the
+// frame that is currently prepared by the CPU
+template <typename T>
+class multi_buffered
+{
+public:
+    multi_buffered(const frame_context& context, std::vector<std::shared_ptr<T>> resources);
+
+    T&
+    current() const;
+
+    std::shared_ptr<T>
+    current_ptr() const;
+
+    T&
+    operator*() const;
+
+    T*
+    operator->() const;
+
+    T&
+    at(GLuint frame_index) const;
+
+    size_t
+    size() const;
+
+protected:
+    const frame_context* context_;
+    std::vector<std::shared_ptr<T>> resources_;
+};
+
+// Tracks up to frames_in_flight frames submitted to the GPU. begin_frame()
+// only blocks if the GPU is still processing the frame that used the same
+// slot frames_in_flight frames ago, so preparing frame N+1 on the CPU
+// overlaps the execution of frame N.
+class frame_context
+{
+public:
+    frame_context(GLuint frames_in_flight = 2);
+
+    frame_context(const frame_context& other) = delete;
+
+    virtual ~frame_context();
+
+    frame_context&
+    operator=(const frame_context& other) = delete;
+
+    GLuint
+    frames_in_flight() const;
+
+    // slot of the current frame in [0, frames_in_flight)
+    GLuint
+    frame_index() const;
+
+    uint64_t
+    frame_number() const;
+
+    void
+    begin_frame();
+
+    // fences all commands issued for the current frame
+    void
+    end_frame();
+
+    // blocks until all frames in flight have been completed
+    void
+    wait_idle();
+
+    template <typename T, typename... Args>
+    multi_buffered<T>
+    make_buffered(Args&&... args) const;
+
+    // calls factory once per frame slot, e.g. [] { return texture::rgba8(w, h); }
+    template <typename Factory>
+    auto
+    generate_buffered(Factory&& factory) const;
+
+protected:
+    GLuint frames_in_flight_;
+    uint64_t frame_number_;
+    bool in_frame_;
+    std::vector<std::optional<fence>> fences_;
+};
+
+}  // namespace baldr
+
+#include "frame_context.ipp"
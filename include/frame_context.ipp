@@ -0,0 +1,66 @@
+namespace baldr {
+
+template <typename T>
+inline
+multi_buffered<T>::multi_buffered(const frame_context& context, std::vector<std::shared_ptr<T>> resources) : context_(&context), resources_(std::move(resources)) {
+    terminate_unless(resources_.size() == context.frames_in_flight(), "multi_buffered resource count ({}) does not match frames in flight ({})", resources_.size(), context.frames_in_flight());
+}
+
+template <typename T>
+inline T&
+multi_buffered<T>::current() const {
+    return *resources_[context_->frame_index()];
+}
+
+template <typename T>
+inline std::shared_ptr<T>
+multi_buffered<T>::current_ptr() const {
+    return resources_[context_->frame_index()];
+}
+
+template <typename T>
+inline T&
+multi_buffered<T>::operator*() const {
+    return current();
+}
+
+template <typename T>
+inline T*
+multi_buffered<T>::operator->() const {
+    return &current();
+}
+
+template <typename T>
+inline T&
+multi_buffered<T>::at(GLuint frame_index) const {
+    return *resources_[frame_index];
+}
+
+template <typename T>
+inline size_t
+multi_buffered<T>::size() const {
+    return resources_.size();
+}
+
+template <typename T, typename... Args>
+inline multi_buffered<T>
+frame_context::make_buffered(Args&&... args) const {
+    std::vector<std::shared_ptr<T>> resources;
+    for (GLuint i = 0; i < frames_in_flight_; ++i) {
+        resources.push_back(std::make_shared<T>(args...));
+    }
+    return multi_buffered<T>(*this, std::move(resources));
+}
+
+template <typename Factory>
+inline auto
+frame_context::generate_buffered(Factory&& factory) const {
+    using resource_t = typename std::invoke_result_t<Factory>::element_type;
+    std::vector<std::shared_ptr<resource_t>> resources;
+    for (GLuint i = 0; i < frames_in_flight_; ++i) {
+        resources.push_back(factory());
+    }
+    return multi_buffered<resource_t>(*this, std::move(resources));
+}
+
+}  // namespace baldr
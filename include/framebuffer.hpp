@@ -31,9 +31,15 @@ public:
     void
     draw_into(GLenum buffer);
 
+    // attaching array, cube map or 3D textures this way yields a layered
+    // attachment, i.e. geometry/vertex shaders select the target via gl_Layer
     void
     attach(GLenum attachment, const texture& tex, GLint level = 0);
 
+    // attaches a single layer (layer-face for cube map arrays, slice for 3D)
+    void
+    attach_layer(GLenum attachment, const texture& tex, GLint layer, GLint level = 0);
+
     void
     detach(GLenum attachment);
 
@@ -41,6 +47,10 @@ public:
     bool
     check();
 
+    // sample count of the attached textures (0 for single sample targets)
+    GLsizei
+    samples() const;
+
     void
     clear_color(const vec4f_t& rgba, GLint draw_buffer = 0);
 
@@ -50,10 +60,14 @@ public:
 protected:
     framebuffer();
 
+    void
+    track_draw_buffer_(GLenum attachment, const texture& tex);
+
 protected:
     GLenum target_;
     GLuint handle_;
     std::set<GLenum> attachments_;
+    std::map<GLenum, GLsizei> samples_;
 };
 
 }  // namespace baldr
@@ -24,7 +24,7 @@ fullscreen_pass::render(const render_options& opts, Uniforms&&... uniforms)
     opt.depth_test = false;
     pass_->render(opt, [&](auto, auto) {
         vao_->bind();
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        vao_->draw_elements(GL_TRIANGLES, 6, GL_UNSIGNED_INT);
     });
 }
 
@@ -38,7 +38,7 @@ fullscreen_pass::render(PreRender&& pre_render, const render_options& opts, Unif
     pass_->render(opt, [&](auto fs, auto vs) {
         pre_render(fs, vs);
         vao_->bind();
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        vao_->draw_elements(GL_TRIANGLES, 6, GL_UNSIGNED_INT);
     });
 }
 
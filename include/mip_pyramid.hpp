@@ -0,0 +1,60 @@
+#pragma once
+
+#include "common.hpp"
+#include "compute_pass.hpp"
+#include "shader_program.hpp"
+#include "texture.hpp"
+
+namespace baldr {
+
+enum class mip_reduction : int {
+    average,
+    min,
+    max
+};
+
+// Builds mip chains of 2D textures with a compute shader. Each texel of the
+// first written level reduces a 2x2 footprint (3x3 at the border of odd sized
+// levels, so min/max pyramids stay conservative); up to four levels are
+// produced per dispatch by reducing further in shared memory.
+//
+// Depth textures cannot be bound as images, so Hi-Z pyramids are built from
+// a depth texture into a separate (e.g. r32f) pyramid texture.
+class mip_pyramid
+{
+public:
+    static constexpr int levels_per_dispatch = 4;
+
+    // internal_format is the format of the textures written to
+    mip_pyramid(GLenum internal_format, mip_reduction reduction = mip_reduction::average);
+
+    // custom reduction given as GLSL expressions: reduce combines two vec4
+    // values a and b, finish maps the reduced vec4 v of n samples to the result
+    mip_pyramid(GLenum internal_format, const std::string& reduce, const std::string& finish = "v");
+
+    virtual ~mip_pyramid();
+
+    // computes all levels of tex after base_level from base_level
+    void
+    generate(texture& tex, int base_level = 0);
+
+    // copies source level 0 into pyramid level 0 (sizes must match) and
+    // computes all remaining pyramid levels
+    void
+    generate(const texture& source, texture& pyramid);
+
+protected:
+    void
+    init_(const std::string& reduce, const std::string& finish);
+
+    // returns the number of target levels written
+    int
+    reduce_(const texture& source, int source_level, texture& target, int target_level, bool copy);
+
+protected:
+    GLenum internal_format_;
+    std::shared_ptr<shader_program> shader_;
+    std::unique_ptr<compute_pass> pass_;
+};
+
+}  // namespace baldr
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "common.hpp"
+#include "compute_pass.hpp"
+#include "framebuffer.hpp"
+#include "shader_program.hpp"
+#include "texture.hpp"
+
+namespace baldr {
+
+enum class resolve_mode : int {
+    average,
+    min,
+    max,
+    // first sample only (e.g. for IDs or normals that must not be blended)
+    first_sample
+};
+
+// Resolves multisample textures into single sample textures of equal size,
+// either by a framebuffer blit (hardware resolve) or with a compute shader
+// reducing the samples of each pixel.
+class msaa_resolve
+{
+public:
+    msaa_resolve();
+
+    virtual ~msaa_resolve();
+
+    // mask is GL_COLOR_BUFFER_BIT or GL_DEPTH_BUFFER_BIT; color samples are
+    // averaged, the depth sample chosen for depth resolves is up to the driver
+    void
+    blit(const texture& source, texture& target, GLbitfield mask = GL_COLOR_BUFFER_BIT);
+
+    // compute resolve into an image bindable target (for depth use e.g. an
+    // r32f target, since depth textures cannot be bound as images)
+    void
+    resolve(const texture& source, texture& target, resolve_mode mode = resolve_mode::average);
+
+protected:
+    struct resolve_shader
+    {
+        std::shared_ptr<shader_program> program;
+        std::unique_ptr<compute_pass> pass;
+    };
+
+    resolve_shader&
+    shader_(resolve_mode mode, GLenum internal_format);
+
+protected:
+    std::shared_ptr<framebuffer> read_fbo_;
+    std::shared_ptr<framebuffer> draw_fbo_;
+    std::map<std::pair<resolve_mode, GLenum>, resolve_shader> shaders_;
+};
+
+}  // namespace baldr
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "common.hpp"
+#include "fence.hpp"
+
+namespace baldr {
+
+class data_buffer;
+
+namespace detail {
+
+struct staging_buffer
+{
+    std::shared_ptr<data_buffer> buffer;
+    std::byte* mapping;
+};
+
+// hands out persistently mapped (read) buffers of at least byte_count bytes;
+// buffers are returned to the pool once the last reference is released
+staging_buffer
+acquire_staging_buffer(GLsizeiptr byte_count);
+
+}  // namespace detail
+
+// Handle to an asynchronous GPU -> CPU transfer. The payload is exposed
+// directly from the persistently mapped staging buffer once the fence
+// inserted after the copy has been signaled.
+class readback
+{
+public:
+    readback(detail::staging_buffer staging, GLsizeiptr byte_count);
+
+    readback(const readback& other) = delete;
+
+    readback(readback&& other) = default;
+
+    virtual ~readback() = default;
+
+    readback&
+    operator=(const readback& other) = delete;
+
+    readback&
+    operator=(readback&& other) = default;
+
+    [[nodiscard]]
+    bool
+    ready() const;
+
+    bool
+    wait(GLuint64 timeout = std::numeric_limits<GLuint64>::max()) const;
+
+    GLsizeiptr
+    byte_count() const;
+
+    // blocks until the transfer is complete
+    std::span<const std::byte>
+    data() const;
+
+    template <typename T>
+    std::span<const T>
+    values() const;
+
+protected:
+    detail::staging_buffer staging_;
+    GLsizeiptr byte_count_;
+    fence fence_;
+};
+
+}  // namespace baldr
+
+#include "readback.ipp"
@@ -0,0 +1,10 @@
+namespace baldr {
+
+template <typename T>
+inline std::span<const T>
+readback::values() const {
+    auto bytes = data();
+    return std::span<const T>(reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T));
+}
+
+}  // namespace baldr
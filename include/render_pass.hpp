@@ -3,12 +3,22 @@
 #include "common.hpp"
 #include "shader_pipeline.hpp"
 #include "texture.hpp"
+#include "sampler.hpp"
 
 namespace baldr {
 
 struct texture_image {
     std::shared_ptr<texture> tex;
     int level;
+    // single layer of an array texture, -1 attaches all layers (gl_Layer)
+    int layer = -1;
+};
+
+// input texture sampled with a (cached) sampler object instead of its own
+// filter/wrap parameters
+struct sampled_texture {
+    std::shared_ptr<texture> tex;
+    std::shared_ptr<sampler> smp;
 };
 
 enum class blend_mode : int {
@@ -29,7 +39,7 @@ enum class blend_mode : int {
 };
 
 struct render_options {
-    std::vector<std::pair<std::string, std::shared_ptr<texture>>> input = {};
+    std::vector<std::pair<std::string, std::variant<std::shared_ptr<texture>, sampled_texture>>> input = {};
     std::vector<std::pair<std::string, std::variant<std::shared_ptr<texture>, texture_image>>> output = {};
     std::shared_ptr<texture> depth_attachment = nullptr;
     bool depth_test = true;
@@ -39,6 +49,10 @@ struct render_options {
     std::optional<float> clear_depth = std::nullopt;
     std::optional<vec4f_t> clear_color = std::nullopt;
     std::optional<std::pair<blend_mode, blend_mode>> blend = std::nullopt;
+    // only effective for multisample targets
+    bool alpha_to_coverage = false;
+    // minimum fraction of samples shaded individually (GL_SAMPLE_SHADING)
+    std::optional<float> sample_shading = std::nullopt;
 };
 
 class render_pass
@@ -59,13 +59,22 @@ render_pass::render(const render_options& opts, Func&& render_call) {
     pipeline_->bind();
 
     for (auto && [var, tex] : opts.input) {
-        fs_->sampler(var) = *tex;
+        std::visit(overloaded {
+            [&, var=var](std::shared_ptr<texture> t) { fs_->sampler(var) = *t; },
+            [&, var=var](sampled_texture st) { fs_->sampler(var).bind(*st.tex, *st.smp); }
+        }, tex);
     }
 
     for (auto && [var, tex] : opts.output) {
         std::visit(overloaded {
             [&, var=var](std::shared_ptr<texture> t) { fs_->output(var) = *t; },
-            [&, var=var](texture_image img) { fs_->output(var).bind_image(*img.tex, img.level); }
+            [&, var=var](texture_image img) {
+                if (img.layer < 0) {
+                    fs_->output(var).bind_image(*img.tex, img.level);
+                } else {
+                    fs_->output(var).bind_layer(*img.tex, img.layer, img.level);
+                }
+            }
         }, tex);
     }
 
@@ -75,6 +84,15 @@ render_pass::render(const render_options& opts, Func&& render_call) {
 
     terminate_unless(fs_->current_framebuffer()->check(), "Incomplete framebuffer");
     fs_->current_framebuffer()->bind();
+
+    bool multisample = fs_->current_framebuffer()->samples() > 1;
+    if (multisample && opts.alpha_to_coverage) {
+        glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+    }
+    if (multisample && opts.sample_shading) {
+        glEnable(GL_SAMPLE_SHADING);
+        glMinSampleShading(*opts.sample_shading);
+    }
     if (opts.output.empty()) {
         GLenum clear_bits = 0;
         if (opts.clear_depth) {
@@ -100,6 +118,12 @@ render_pass::render(const render_options& opts, Func&& render_call) {
     if (opts.blend) {
         glDisable(GL_BLEND);
     }
+    if (multisample && opts.alpha_to_coverage) {
+        glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+    }
+    if (multisample && opts.sample_shading) {
+        glDisable(GL_SAMPLE_SHADING);
+    }
 }
 
 } // baldr
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <mutex>
+
+namespace baldr {
+
+enum class resource_category : int {
+    texture,
+    buffer
+};
+
+struct resource_usage
+{
+    size_t bytes = 0;
+    size_t high_water_mark = 0;
+    size_t count = 0;
+    // allocations resp. growths the evictors could not fit into the budget
+    // (only counted in the process-wide usage())
+    size_t over_budget = 0;
+};
+
+// Process-wide accounting of GPU allocations. textures and data_buffers
+// register their storage size on creation; allocations can be tagged for
+// per-owner totals. With a budget set, registered evictors (e.g. pools and
+// caches) are asked to release memory before an allocation would exceed it.
+class resource_registry
+{
+public:
+    using resource_id = uint64_t;
+    using evictor_id = uint64_t;
+    // releases cached resources, bytes_needed is a hint on how much to free
+    using evictor = std::function<void(size_t bytes_needed)>;
+
+    static resource_registry&
+    instance();
+
+    resource_registry(const resource_registry& other) = delete;
+
+    resource_registry&
+    operator=(const resource_registry& other) = delete;
+
+    // evicts if necessary to stay within budget; allocations exceeding the
+    // budget even after eviction are still registered (and reported)
+    resource_id
+    add(resource_category category, size_t bytes);
+
+    void
+    resize(resource_id id, size_t bytes);
+
+    void
+    remove(resource_id id);
+
+    void
+    tag(resource_id id, const std::string& tag);
+
+    size_t
+    bytes(resource_id id) const;
+
+    resource_usage
+    usage() const;
+
+    resource_usage
+    usage(resource_category category) const;
+
+    resource_usage
+    usage(const std::string& tag) const;
+
+    std::map<std::string, resource_usage>
+    tag_usage() const;
+
+    // std::nullopt disables the budget
+    void
+    set_budget(std::optional<size_t> bytes);
+
+    std::optional<size_t>
+    budget() const;
+
+    evictor_id
+    add_evictor(evictor func);
+
+    void
+    remove_evictor(evictor_id id);
+
+    // runs evictors until at least bytes_needed fit into the budget (or all
+    // evictors ran); returns whether the allocation fits
+    bool
+    make_room(size_t bytes_needed);
+
+protected:
+    struct resource
+    {
+        resource_category category;
+        size_t bytes;
+        std::string tag;
+    };
+
+    resource_registry() = default;
+
+    static void
+    add_bytes_(resource_usage& usage, size_t bytes);
+
+    static void
+    sub_bytes_(resource_usage& usage, size_t bytes);
+
+protected:
+    mutable std::mutex mutex_;
+    resource_id next_id_ = 1;
+    evictor_id next_evictor_ = 1;
+    std::map<resource_id, resource> resources_;
+    resource_usage total_;
+    std::map<resource_category, resource_usage> categories_;
+    std::map<std::string, resource_usage> tags_;
+    std::optional<size_t> budget_;
+    std::vector<std::pair<evictor_id, evictor>> evictors_;
+};
+
+}  // namespace baldr
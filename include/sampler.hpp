@@ -0,0 +1,74 @@
+#pragma once
+
+#include "common.hpp"
+
+namespace baldr {
+
+struct sampler_state
+{
+    std::tuple<GLint, GLint> filter = {GL_LINEAR, GL_LINEAR};
+    std::tuple<GLint, GLint, GLint> wrap_mode = {
+        GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE};
+    float max_anisotropy = 1.f;
+    // GL_NONE or the depth comparison function (e.g. GL_LEQUAL) of shadow samplers
+    GLenum compare_func = GL_NONE;
+
+    auto operator<=>(const sampler_state& other) const = default;
+};
+
+struct sampler_state_hash
+{
+    size_t
+    operator()(const sampler_state& state) const;
+};
+
+// Sampler object overriding the sampling parameters of textures bound to the
+// same unit. Samplers are deduplicated: get() returns the cached instance for
+// equal states as long as it is referenced somewhere.
+class sampler
+{
+public:
+    sampler(const sampler_state& state);
+
+    sampler(const sampler& other) = delete;
+
+    virtual ~sampler();
+
+    sampler&
+    operator=(const sampler& other) = delete;
+
+    static std::shared_ptr<sampler>
+    get(const sampler_state& state);
+
+    static std::shared_ptr<sampler>
+    nearest(GLint wrap_mode = GL_CLAMP_TO_EDGE);
+
+    static std::shared_ptr<sampler>
+    linear(GLint wrap_mode = GL_CLAMP_TO_EDGE);
+
+    static std::shared_ptr<sampler>
+    trilinear(GLint wrap_mode = GL_REPEAT, float max_anisotropy = 1.f);
+
+    // binds samplers to consecutive units starting at first_unit with a single
+    // glBindSamplers call, null entries reset units to the texture parameters
+    static void
+    bind(GLuint first_unit, std::span<const std::shared_ptr<sampler>> samplers);
+
+    static void
+    unbind(GLuint unit);
+
+    GLuint
+    handle() const;
+
+    const sampler_state&
+    state() const;
+
+    void
+    bind(GLuint unit) const;
+
+protected:
+    GLuint handle_;
+    sampler_state state_;
+};
+
+}  // namespace baldr
@@ -10,6 +10,8 @@ public:
     template <typename... Stages>
     shader_pipeline(Stages&&... stages);
 
+    // fails if a block of the stage shares its binding point with a
+    // different block of another stage
     void
     add_stage(std::shared_ptr<shader_program> shader);
 
@@ -19,8 +21,13 @@ public:
     static void
     release();
 
+protected:
+    void
+    check_bindings_(const shader_program& shader) const;
+
 protected:
     GLuint handle_;
+    std::map<GLenum, std::shared_ptr<shader_program>> stages_;
 };
 
 } // baldr
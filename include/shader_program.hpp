@@ -1,11 +1,14 @@
 #pragma once
 
 #include <fstream>
+#include <set>
 
 #include "common.hpp"
 #include "vertex_array.hpp"
 #include "texture.hpp"
+#include "sampler.hpp"
 #include "framebuffer.hpp"
+#include "buffer_layout.hpp"
 
 namespace baldr {
 
@@ -37,25 +40,93 @@ struct shader_output
     void
     bind_image(const texture& tex, int level) const;
 
+    void
+    bind_layer(const texture& tex, int layer, int level = 0) const;
+
     GLenum type;
     GLint location;
     std::weak_ptr<shader_program> program;
 };
 
+struct buffer_variable
+{
+    GLenum type;
+    GLuint offset;
+    GLuint array_size;
+    GLuint array_stride;
+    GLuint matrix_stride;
+    // size/stride of the outermost array (0 size for runtime sized arrays)
+    GLuint top_level_array_size;
+    GLuint top_level_array_stride;
+};
+
 struct shader_ssbo
 {
     const shader_ssbo& operator=(const data_buffer& buffer) const;
 
+    const shader_ssbo& operator=(const buffer_allocation& allocation) const;
+
+    // binds byte_count bytes starting at offset (e.g. a streaming_buffer region)
+    void
+    bind(const data_buffer& buffer, GLintptr offset, GLsizeiptr byte_count) const;
+
+    const buffer_variable&
+    variable(const std::string& name) const;
+
     GLuint binding_point;
+    std::string name;
+    // size of the block with runtime sized arrays having a single element
+    GLuint byte_count;
+    // std430 layout of all active buffer variables, named as reflected
+    // (e.g. "points[0].position" for runtime arrays of structs)
+    std::map<std::string, buffer_variable> variables;
+};
+
+struct uniform_block_member
+{
+    GLenum type;
+    GLuint offset;
+    GLuint array_size;
+    GLuint array_stride;
+    GLuint matrix_stride;
+};
+
+struct shader_uniform_block
+{
+    const shader_uniform_block& operator=(const data_buffer& buffer) const;
+
+    const shader_uniform_block& operator=(const buffer_allocation& allocation) const;
+
+    void
+    bind(const data_buffer& buffer, GLintptr offset, GLsizeiptr byte_count) const;
+
+    const uniform_block_member&
+    member(const std::string& name) const;
+
+    // checks that the std140_struct member offsets and size match the block
+    // layout reflected from the shader; names are given in member order
+    template <typename Layout>
+    void
+    validate(const std::array<std::string, Layout::member_count>& names) const;
+
+    std::string name;
+    GLuint binding_point;
+    GLuint byte_count;
+    std::map<std::string, uniform_block_member> members;
 };
 
 struct sampler_unit
 {
+    // samples tex with its own parameters (resets the unit's sampler object)
     const sampler_unit& operator=(const texture& tex) const;
 
+    void
+    bind(const texture& tex, const sampler& smp) const;
+
     GLuint unit;
     GLint location;
     std::weak_ptr<shader_program> program;
+    GLuint array_size = 1;
 };
 
 struct image_unit
@@ -64,6 +135,10 @@ struct image_unit
     void
     bind(const texture& tex, int level = 0, GLenum access = GL_READ_WRITE) const;
 
+    // binds a single layer of an array/cube map/3D texture as a non-layered image
+    void
+    bind_layer(const texture& tex, int layer, int level = 0, GLenum access = GL_READ_WRITE) const;
+
     void
     release(const texture& tex, int level = 0) const;
 
@@ -96,6 +171,7 @@ class shader_program : public std::enable_shared_from_this<shader_program>
 protected:
     friend struct shader_output;
     friend struct framebuffer_depth_attachment;
+    friend class shader_pipeline;
 
 public:
     static std::shared_ptr<shader_program>
@@ -144,6 +220,9 @@ public:
     const shader_ssbo&
     ssbo(const std::string& name) const;
 
+    const shader_uniform_block&
+    uniform_block(const std::string& name) const;
+
     framebuffer_depth_attachment
     depth_attachment();
 
@@ -173,7 +252,13 @@ protected:
     query_ssbo_();
 
     void
-    attach_texture_(GLenum attachment, const texture& tex, GLint level = 0);
+    query_uniform_blocks_();
+
+    bool
+    explicit_binding_(const std::string& storage, const std::string& block) const;
+
+    void
+    attach_texture_(GLenum attachment, const texture& tex, GLint level = 0, GLint layer = -1);
 
 protected:
     GLuint shader_;
@@ -186,6 +271,10 @@ protected:
     std::map<std::string, shader_input> input_;
     std::map<std::string, shader_output> output_;
     std::map<std::string, shader_ssbo> ssbo_;
+    std::map<std::string, shader_uniform_block> uniform_blocks_;
+    // blocks declared with layout(binding = N); unknown for SPIR-V programs,
+    // which have to bind every block explicitly
+    std::optional<std::set<std::pair<std::string, std::string>>> explicit_bindings_;
 };
 
 }  // namespace baldr
@@ -50,6 +50,35 @@ shader_uniform::operator=(T&& value) const {
     return *this;
 }
 
+inline const uniform_block_member&
+shader_uniform_block::member(const std::string& member_name) const {
+    auto find_it = members.find(member_name);
+    if (find_it == members.end()) {
+        fail("\"{}\" is not an active member of uniform block \"{}\"", member_name, name);
+    }
+    return find_it->second;
+}
+
+inline const buffer_variable&
+shader_ssbo::variable(const std::string& variable_name) const {
+    auto find_it = variables.find(variable_name);
+    if (find_it == variables.end()) {
+        fail("\"{}\" is not an active buffer variable of SSBO \"{}\"", variable_name, name);
+    }
+    return find_it->second;
+}
+
+template <typename Layout>
+inline void
+shader_uniform_block::validate(const std::array<std::string, Layout::member_count>& names) const {
+    constexpr auto offsets = Layout::offsets();
+    for (size_t i = 0; i < names.size(); ++i) {
+        const auto& m = member(names[i]);
+        terminate_unless(m.offset == offsets[i], "Offset mismatch for member \"{}\" of uniform block \"{}\" (shader: {}, host: {})", names[i], name, m.offset, offsets[i]);
+    }
+    terminate_unless(Layout::byte_count() >= byte_count, "Host layout for uniform block \"{}\" is smaller than the shader block ({} < {} bytes)", name, Layout::byte_count(), byte_count);
+}
+
 inline bool
 shader_program::valid() const
 {
@@ -127,6 +156,15 @@ shader_program::ssbo(const std::string& name) const {
     return find_it->second;
 }
 
+inline const shader_uniform_block&
+shader_program::uniform_block(const std::string& name) const {
+    auto find_it = uniform_blocks_.find(name);
+    if (find_it == uniform_blocks_.end()) {
+        fail("Uniform block \"{}\" not an active shader uniform block", name);
+    }
+    return find_it->second;
+}
+
 inline framebuffer_depth_attachment
 shader_program::depth_attachment() {
     return { weak_from_this() };
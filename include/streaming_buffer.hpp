@@ -0,0 +1,92 @@
+#pragma once
+
+#include "common.hpp"
+#include "data_buffer.hpp"
+#include "fence.hpp"
+
+namespace baldr {
+
+struct streaming_region
+{
+    GLuint index;
+    GLintptr offset;
+    GLsizeiptr byte_count;
+    std::byte* data;
+};
+
+// Persistently and coherently mapped buffer split into region_count regions
+// that are written round-robin (typically one region per frame). Each region
+// is guarded by a fence so that acquiring it again only blocks if the GPU is
+// still reading the data written region_count acquisitions ago.
+class streaming_buffer : public data_buffer
+{
+public:
+    streaming_buffer(GLuint region_byte_count, GLuint region_count = 3, GLbitfield map_flags = GL_MAP_WRITE_BIT);
+
+    virtual ~streaming_buffer();
+
+    GLuint
+    region_count() const;
+
+    GLuint
+    region_byte_count() const;
+
+    // required offset alignment for uniform/storage buffer range bindings
+    GLuint
+    alignment() const;
+
+    // advances to the next region and waits until the GPU released it
+    streaming_region
+    acquire();
+
+    // fences the current region; call after all commands reading from it
+    // have been issued
+    void
+    release();
+
+    // fences a specific region, for users that keep several regions
+    // outstanding (e.g. filled by worker threads)
+    void
+    release(const streaming_region& region);
+
+    // suballocates byte_count bytes from the current region and returns the
+    // absolute buffer offset of the allocation; alignment 0 uses alignment()
+    GLintptr
+    allocate(GLsizeiptr byte_count, GLuint alignment = 0);
+
+    // number of bytes still available in the current region
+    GLsizeiptr
+    available(GLuint alignment = 0) const;
+
+    // copies data into a suballocation of the current region
+    GLintptr
+    write(const void* data, GLsizeiptr byte_count);
+
+    template <typename T>
+    GLintptr
+    write(const std::vector<T>& data);
+
+    template <typename T>
+    GLintptr
+    write(const T& value);
+
+    std::byte*
+    mapped(GLintptr offset);
+
+    const streaming_region&
+    current_region() const;
+
+protected:
+    GLuint region_count_;
+    GLuint region_byte_count_;
+    GLuint alignment_;
+    GLuint current_;
+    GLsizeiptr used_;
+    std::byte* mapping_;
+    streaming_region region_;
+    std::vector<std::optional<fence>> fences_;
+};
+
+}  // namespace baldr
+
+#include "streaming_buffer.ipp"
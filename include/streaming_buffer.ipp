@@ -0,0 +1,16 @@
+namespace baldr {
+
+template <typename T>
+inline GLintptr
+streaming_buffer::write(const std::vector<T>& data) {
+    return write(reinterpret_cast<const void*>(data.data()), data.size() * sizeof(T));
+}
+
+template <typename T>
+inline GLintptr
+streaming_buffer::write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "streaming_buffer::write requires trivially copyable types");
+    return write(reinterpret_cast<const void*>(&value), sizeof(T));
+}
+
+}  // namespace baldr
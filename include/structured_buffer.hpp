@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common.hpp"
+#include "data_buffer.hpp"
+#include "shader_program.hpp"
+
+namespace baldr {
+
+// Buffer of native T values used as a std430 storage buffer (either a block
+// with a single runtime sized array of T or a block whose layout is T).
+// Values are uploaded directly without repacking, the layout of T is checked
+// against the shader reflection when binding.
+template <typename T>
+class structured_buffer : public data_buffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "structured_buffer element types must be trivially copyable");
+    static_assert(std::is_standard_layout_v<T>, "structured_buffer element types must have standard layout");
+    static_assert(sizeof(T) % 4 == 0, "std430 element sizes are multiples of 4 bytes");
+
+public:
+    // reflected variable name (e.g. "points[0].normal") and offsetof() in T
+    using field = std::pair<std::string, size_t>;
+
+    structured_buffer(size_t count, GLenum usage_hint = GL_DYNAMIC_DRAW);
+
+    structured_buffer(std::span<const T> values, GLenum usage_hint = GL_STATIC_DRAW);
+
+    structured_buffer(std::span<const T> values, immutable_storage storage);
+
+    size_t
+    size() const;
+
+    void
+    set(std::span<const T> values, GLuint first = 0);
+
+    void
+    get(std::span<T> values, GLuint first = 0) const;
+
+    void
+    validate(const shader_ssbo& ssbo, const std::vector<field>& fields = {}) const;
+
+    void
+    bind(const shader_ssbo& ssbo, const std::vector<field>& fields = {}) const;
+};
+
+}  // namespace baldr
+
+#include "structured_buffer.ipp"
@@ -0,0 +1,73 @@
+namespace baldr {
+
+template <typename T>
+inline
+structured_buffer<T>::structured_buffer(size_t count, GLenum usage_hint)
+    : data_buffer(count * sizeof(T), usage_hint)
+{}
+
+template <typename T>
+inline
+structured_buffer<T>::structured_buffer(std::span<const T> values, GLenum usage_hint)
+    : data_buffer(values.size_bytes(), usage_hint, reinterpret_cast<const void*>(values.data()))
+{}
+
+template <typename T>
+inline
+structured_buffer<T>::structured_buffer(std::span<const T> values, immutable_storage storage)
+    : data_buffer(values.size_bytes(), storage, reinterpret_cast<const void*>(values.data()))
+{}
+
+template <typename T>
+inline size_t
+structured_buffer<T>::size() const {
+    return value_count<T>();
+}
+
+template <typename T>
+inline void
+structured_buffer<T>::set(std::span<const T> values, GLuint first) {
+    set_data(values, first);
+}
+
+template <typename T>
+inline void
+structured_buffer<T>::get(std::span<T> values, GLuint first) const {
+    get_data(values, first);
+}
+
+template <typename T>
+inline void
+structured_buffer<T>::validate(const shader_ssbo& ssbo, const std::vector<field>& fields) const {
+    std::optional<GLuint> base, stride;
+    for (const auto& [name, var] : ssbo.variables) {
+        if (var.top_level_array_stride && !var.top_level_array_size) {
+            terminate_unless(!stride || *stride == var.top_level_array_stride, "SSBO \"{}\" contains more than one runtime sized array", ssbo.name);
+            stride = var.top_level_array_stride;
+            base = std::min(base.value_or(var.offset), var.offset);
+        }
+    }
+
+    if (stride) {
+        terminate_unless(*base == 0, "Runtime sized array in SSBO \"{}\" starts at offset {}, structured_buffer requires it to be the only member", ssbo.name, *base);
+        terminate_unless(*stride == sizeof(T), "Element size mismatch for SSBO \"{}\" (std430 stride: {}, sizeof(T): {})", ssbo.name, *stride, sizeof(T));
+    } else {
+        terminate_unless(sizeof(T) >= ssbo.byte_count, "Type too small for SSBO \"{}\" (std430 size: {}, sizeof(T): {})", ssbo.name, ssbo.byte_count, sizeof(T));
+    }
+
+    for (const auto& [name, offset] : fields) {
+        const buffer_variable& var = ssbo.variable(name);
+        terminate_unless(var.offset == offset, "Offset mismatch for \"{}\" in SSBO \"{}\" (std430: {}, host: {})", name, ssbo.name, var.offset, offset);
+    }
+}
+
+template <typename T>
+inline void
+structured_buffer<T>::bind(const shader_ssbo& ssbo, const std::vector<field>& fields) const {
+    if constexpr (debug) {
+        validate(ssbo, fields);
+    }
+    ssbo = *this;
+}
+
+}  // namespace baldr
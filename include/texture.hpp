@@ -1,9 +1,51 @@
 #pragma once
 
 #include "common.hpp"
+#include "data_buffer.hpp"
+#include "resource_registry.hpp"
 
 namespace baldr {
 
+class texture_streamer;
+class sampler;
+
+namespace detail {
+
+// GL pixel transfer type corresponding to component type T
+template <typename T>
+constexpr GLenum
+pixel_type();
+
+// number of components of a pixel transfer format (e.g. 4 for GL_RGBA_INTEGER)
+constexpr uint32_t
+channel_count(GLenum format);
+
+// bytes per 4x4 block of a block-compressed (BCn/RGTC/BPTC) internal format,
+// 0 for uncompressed formats
+GLsizei
+compressed_block_bytes(GLenum internal_format);
+
+// true for (unsigned) integer internal formats that need *_INTEGER pixel formats
+bool
+integer_format(GLenum internal_format);
+
+// bytes per pixel of an uncompressed internal format
+GLsizei
+internal_format_bytes(GLenum internal_format);
+
+// GLSL image format layout qualifier (e.g. "rgba16f") of an internal format
+const char*
+image_format_qualifier(GLenum internal_format);
+
+}  // namespace detail
+
+struct texture_region
+{
+    // x, y and z/layer/cubemap face
+    vec3i_t offset;
+    vec3i_t extent;
+};
+
 struct texture_specification
 {
     GLuint format;
@@ -14,6 +56,12 @@ struct texture_specification
     GLuint levels = 1;
     GLuint border = 0;
     bool cubemap = false;
+    // the last dimension counts layers (1D/2D arrays) resp. cubes (cube map arrays)
+    bool array = false;
+    // sample count of multisample textures (2D and 2D arrays), 0 otherwise
+    GLsizei samples = 0;
+
+    auto operator<=>(const texture_specification& other) const = default;
 };
 
 class texture
@@ -67,11 +115,105 @@ public:
     static std::shared_ptr<texture>
     depth32f(Is... dimensions);
 
+    // block-compressed storage, dimensions should be multiples of 4
+    template <typename... Is>
+    static std::shared_ptr<texture>
+    compressed(GLenum internal_format, GLuint levels, Is... dimensions);
+
+    template <typename... Is>
+    static std::shared_ptr<texture>
+    bc1(Is... dimensions);
+
+    template <typename... Is>
+    static std::shared_ptr<texture>
+    bc3(Is... dimensions);
+
+    template <typename... Is>
+    static std::shared_ptr<texture>
+    bc4(Is... dimensions);
+
+    template <typename... Is>
+    static std::shared_ptr<texture>
+    bc5(Is... dimensions);
+
+    template <typename... Is>
+    static std::shared_ptr<texture>
+    bc6h(Is... dimensions);
+
+    template <typename... Is>
+    static std::shared_ptr<texture>
+    bc7(Is... dimensions);
+
+    static std::shared_ptr<texture>
+    array_2d(int32_t width, int32_t height, int32_t layers, texture_specification specs);
+
+    static std::shared_ptr<texture>
+    cubemap_array(int32_t size, int32_t cubes, texture_specification specs);
+
+    static std::shared_ptr<texture>
+    multisample(int32_t width, int32_t height, GLsizei samples, texture_specification specs);
+
     virtual ~texture();
 
+    // Zero-copy view on a range of levels and layers (layer-faces for cube
+    // maps) reinterpreted with a compatible internal format. The view shares
+    // storage with this texture and stays valid after its deletion; single
+    // layers/faces yield non-array textures, multiples of 6 faces cube maps.
+    // A count of -1 selects all remaining levels resp. layers.
+    std::shared_ptr<texture>
+    view(GLenum internal_format, std::pair<int, int> level_range = {0, -1}, std::pair<int, int> layer_range = {0, -1}) const;
+
     GLuint
     handle() const;
 
+    GLenum
+    target() const;
+
+    // true for textures with layers, faces or slices (arrays, cube maps, 3D)
+    [[ nodiscard ]]
+    bool layered() const noexcept;
+
+    // number of layers (times 6 for cube map arrays) resp. 1 for non-arrays
+    [[ nodiscard ]]
+    int layer_count() const noexcept;
+
+    // sample count of multisample textures resp. 0
+    [[ nodiscard ]]
+    GLsizei samples() const noexcept;
+
+    // GPU memory of all levels, layers and samples (views are not registered
+    // in the resource_registry since they share their parent's storage)
+    [[ nodiscard ]]
+    size_t storage_bytes() const;
+
+    // groups the texture in the resource_registry statistics
+    void
+    tag(const std::string& tag);
+
+    // whether the current context supports ARB_bindless_texture
+    static bool
+    bindless_supported();
+
+    // 64-bit bindless handle using the texture parameters or the state of smp;
+    // note that texture parameters resp. sampler state are frozen afterwards
+    GLuint64
+    bindless_handle(const sampler* smp = nullptr);
+
+    // reference counted residency of the handle
+    void
+    make_resident(const sampler* smp = nullptr);
+
+    void
+    make_non_resident(const sampler* smp = nullptr);
+
+    // whether a bindless handle has been created, i.e. parameters are frozen
+    bool
+    has_bindless_handle() const;
+
+    // makes all handles non-resident regardless of their residency counts
+    void
+    release_residency();
+
     [[ nodiscard ]]
     int width() const noexcept;
 
@@ -84,6 +226,11 @@ public:
     [[ nodiscard ]]
     int pixel_count() const noexcept;
 
+    // width, height and depth (resp. face count for cubemaps) of a mip level,
+    // unused dimensions are 1
+    [[ nodiscard ]]
+    vec3i_t level_size(int level) const noexcept;
+
     void
     set_filter(std::tuple<GLint, GLint> filter);
 
@@ -116,10 +263,70 @@ public:
     void
     set_cubemap_faces(const T* data, int level=0);
 
+    // updates a sub-region (offset z selects the layer/face); row_length and
+    // image_height describe the source image if the region is cut out of a
+    // larger one (0 = tightly packed)
+    template <typename T>
+    void
+    set(const T* data, const texture_region& region, int level = 0, int row_length = 0, int image_height = 0);
+
+    // untyped variant for pixel types only known at runtime
+    void
+    set(const void* data, GLenum pixel_type, const texture_region& region, int level = 0);
+
+    // uploads a whole level (all faces for cubemaps) from a pixel unpack
+    // buffer starting at byte offset
+    void
+    set(const data_buffer& pixels, GLintptr offset, GLenum pixel_type, int level = 0);
+
+    [[ nodiscard ]]
+    bool compressed() const;
+
+    // size of a compressed mip level (all layers/faces) in bytes
+    [[ nodiscard ]]
+    GLsizei compressed_level_bytes(int level) const;
+
+    // uploads a block-compressed level (resp. block aligned region of it)
+    void
+    set_compressed(const void* data, GLsizei byte_count, int level = 0, std::optional<texture_region> region = std::nullopt);
+
+    void
+    set_compressed(const data_buffer& blocks, GLintptr offset, GLsizei byte_count, int level = 0);
+
+    // stages data in a persistently mapped pixel unpack buffer slot of the
+    // streamer instead of handing the client pointer to the driver
+    template <typename T>
+    void
+    set_async(texture_streamer& streamer, const T* data, int level = 0);
+
     template <typename T>
     void
     get(GLint level, T* data);
 
+    template <typename T>
+    void
+    get(GLint level, const texture_region& region, T* data, int row_length = 0, int image_height = 0);
+
+    // layer of an array texture (layer-face index for cube map arrays)
+    template <typename T>
+    void
+    set_layer(const T* data, int layer, int level = 0);
+
+    template <typename T>
+    void
+    get_layer(GLint level, int layer, T* data);
+
+    // packs the region (default: whole level) into a pooled pixel pack buffer
+    // and fences the transfer instead of stalling until rendering finished
+    template <typename T>
+    [[nodiscard]]
+    readback
+    read_async(GLint level = 0, std::optional<texture_region> region = std::nullopt) const;
+
+    [[nodiscard]]
+    texture_region
+    level_region(int level) const noexcept;
+
     void
     generate_mipmap();
 
@@ -129,8 +336,34 @@ public:
     const texture_specification&
     specification() const;
 
+protected:
+    // takes ownership of an existing texture handle (e.g. a view)
+    texture(GLuint handle, GLenum target, int32_t width, int32_t height, int32_t depth, texture_specification specs);
+
+    texture_region
+    layer_region_(int layer, int level) const;
+
+    void
+    set_compressed_(const void* data, GLsizei byte_count, int level, const texture_region& region);
+
+    void
+    set_region_(const void* data, const texture_region& region, int level, GLenum pixel_type, int row_length, int image_height);
+
+    void
+    get_region_(void* data, size_t byte_count, const texture_region& region, int level, GLenum pixel_type, int row_length, int image_height);
+
+    readback
+    read_async_(GLint level, const texture_region& region, GLenum pixel_type, size_t value_size) const;
+
+    void
+    set_async_(texture_streamer& streamer, const void* data, int level, GLenum pixel_type, size_t value_size);
+
 protected:
     GLuint handle_;
+    GLenum target_;
+    resource_registry::resource_id resource_id_ = 0;
+    // bindless handles and residency counts by sampler (0 = texture parameters)
+    std::map<GLuint, std::pair<GLuint64, uint32_t>> bindless_;
     int width_;
     int height_;
     int depth_;
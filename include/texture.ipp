@@ -1,5 +1,51 @@
 namespace baldr {
 
+namespace detail {
+
+template <typename T>
+constexpr GLenum
+pixel_type() {
+    if constexpr (std::is_same_v<T, float>) {
+        return GL_FLOAT;
+    } else if constexpr (std::is_same_v<T, uint8_t>) {
+        return GL_UNSIGNED_BYTE;
+    } else if constexpr (std::is_same_v<T, int8_t>) {
+        return GL_BYTE;
+    } else if constexpr (std::is_same_v<T, uint16_t>) {
+        return GL_UNSIGNED_SHORT;
+    } else if constexpr (std::is_same_v<T, int16_t>) {
+        return GL_SHORT;
+    } else if constexpr (std::is_same_v<T, uint32_t>) {
+        return GL_UNSIGNED_INT;
+    } else {
+        static_assert(std::is_same_v<T, int32_t>, "Unsupported pixel component type");
+        return GL_INT;
+    }
+}
+
+constexpr uint32_t
+channel_count(GLenum format) {
+    switch (format) {
+        case GL_RG:
+        case GL_RG_INTEGER:
+            return 2u;
+        case GL_RGB:
+        case GL_RGB_INTEGER:
+        case GL_BGR:
+        case GL_BGR_INTEGER:
+            return 3u;
+        case GL_RGBA:
+        case GL_RGBA_INTEGER:
+        case GL_BGRA:
+        case GL_BGRA_INTEGER:
+            return 4u;
+        default:
+            return 1u;
+    }
+}
+
+}  // namespace detail
+
 template <typename... Is>
 inline std::shared_ptr<texture>
 texture::r32f(Is... dimensions) {
@@ -108,24 +154,101 @@ texture::depth32f(Is... dimensions) {
     ));
 }
 
+template <typename T>
+inline void
+texture::set(const T* data, const texture_region& region, int level, int row_length, int image_height) {
+    if (!data) return;
+    set_region_(data, region, level, detail::pixel_type<T>(), row_length, image_height);
+}
+
+template <typename T>
+inline void
+texture::get(GLint level, const texture_region& region, T* data, int row_length, int image_height) {
+    if (!data) return;
+
+    const auto& extent = region.extent;
+    size_t row = row_length ? row_length : extent[0];
+    size_t rows = image_height ? image_height : extent[1];
+    size_t value_count = ((extent[2] - 1) * rows * row + (extent[1] - 1) * row + extent[0]) * channel_count();
+    get_region_(data, value_count * sizeof(T), region, level, detail::pixel_type<T>(), row_length, image_height);
+}
+
+template <typename... Is>
+inline std::shared_ptr<texture>
+texture::compressed(GLenum internal_format, GLuint levels, Is... dimensions) {
+    texture_specification specs{
+        internal_format,
+        internal_format
+    };
+    specs.levels = levels;
+    return std::shared_ptr<texture>(new texture(dimensions..., specs));
+}
+
+template <typename... Is>
+inline std::shared_ptr<texture>
+texture::bc1(Is... dimensions) {
+    return compressed(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 1, dimensions...);
+}
+
+template <typename... Is>
+inline std::shared_ptr<texture>
+texture::bc3(Is... dimensions) {
+    return compressed(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 1, dimensions...);
+}
+
+template <typename... Is>
+inline std::shared_ptr<texture>
+texture::bc4(Is... dimensions) {
+    return compressed(GL_COMPRESSED_RED_RGTC1, 1, dimensions...);
+}
+
+template <typename... Is>
+inline std::shared_ptr<texture>
+texture::bc5(Is... dimensions) {
+    return compressed(GL_COMPRESSED_RG_RGTC2, 1, dimensions...);
+}
+
+template <typename... Is>
+inline std::shared_ptr<texture>
+texture::bc6h(Is... dimensions) {
+    return compressed(GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 1, dimensions...);
+}
+
+template <typename... Is>
+inline std::shared_ptr<texture>
+texture::bc7(Is... dimensions) {
+    return compressed(GL_COMPRESSED_RGBA_BPTC_UNORM, 1, dimensions...);
+}
+
+template <typename T>
+inline void
+texture::set_layer(const T* data, int layer, int level) {
+    set(data, layer_region_(layer, level), level);
+}
+
+template <typename T>
+inline void
+texture::get_layer(GLint level, int layer, T* data) {
+    get(level, layer_region_(layer, level), data);
+}
+
+template <typename T>
+inline readback
+texture::read_async(GLint level, std::optional<texture_region> region) const {
+    return read_async_(level, region.value_or(level_region(level)), detail::pixel_type<T>(), sizeof(T));
+}
+
+template <typename T>
+inline void
+texture::set_async(texture_streamer& streamer, const T* data, int level) {
+    set_async_(streamer, data, level, detail::pixel_type<T>(), sizeof(T));
+}
+
 template <typename T, int Channels>
 inline void
 texture::clear(Eigen::Matrix<T, Channels, 1> values, int level) {
     terminate_unless(static_cast<int>(channel_count()) == Channels, "Vector clear() function used for texture with wrong channel count (texture: {}, values: {})", channel_count(), Channels);
-    GLuint pixel_type = GL_INT;
-    if constexpr (std::is_same_v<T, float>) {
-        pixel_type = GL_FLOAT;
-    } else if (std::is_same_v<T, uint8_t>) {
-        pixel_type = GL_UNSIGNED_BYTE;
-    } else if (std::is_same_v<T, int8_t>) {
-        pixel_type = GL_BYTE;
-    } else if (std::is_same_v<T, uint16_t>) {
-        pixel_type = GL_UNSIGNED_SHORT;
-    } else if (std::is_same_v<T, int16_t>) {
-        pixel_type = GL_SHORT;
-    } else if (std::is_same_v<T, uint32_t>) {
-        pixel_type = GL_UNSIGNED_INT;
-    }
+    constexpr GLenum pixel_type = detail::pixel_type<T>();
 
     glClearTexImage(handle_, level, specs_.format, pixel_type, values.data());
 }
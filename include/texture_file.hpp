@@ -0,0 +1,133 @@
+#pragma once
+
+#include "common.hpp"
+#include "texture.hpp"
+
+namespace baldr {
+
+// read-only memory mapping of a whole file
+class mapped_file
+{
+public:
+    mapped_file(const std::filesystem::path& path);
+
+    mapped_file(const mapped_file& other) = delete;
+
+    mapped_file(mapped_file&& other) noexcept;
+
+    virtual ~mapped_file();
+
+    mapped_file&
+    operator=(const mapped_file& other) = delete;
+
+    mapped_file&
+    operator=(mapped_file&& other) noexcept;
+
+    std::span<const std::byte>
+    data() const;
+
+    size_t
+    size() const;
+
+protected:
+    void
+    close_();
+
+protected:
+    const std::byte* data_;
+    size_t size_;
+#ifdef _MSC_VER
+    HANDLE file_;
+    HANDLE mapping_;
+#else
+    int fd_;
+#endif
+};
+
+// KTX2 (without supercompression) or DDS texture file. Images are referenced
+// in place inside the file mapping and uploaded from there, so no pixel data
+// is copied on the CPU side.
+class texture_file
+{
+public:
+    // terminates on unsupported or malformed files
+    texture_file(const std::filesystem::path& path);
+
+    // returns nullptr (and the reason in error, if given) for unsupported or
+    // malformed files instead of terminating; the file has to exist
+    static std::unique_ptr<texture_file>
+    open(const std::filesystem::path& path, std::string* error = nullptr);
+
+    // true if data starts with a KTX2 or DDS signature
+    static bool
+    recognized(std::span<const std::byte> data);
+
+    static std::shared_ptr<texture>
+    load(const std::filesystem::path& path);
+
+    const texture_specification&
+    specification() const;
+
+    // width, height and depth resp. layer count (cube count for cube map arrays)
+    vec3i_t
+    extent() const;
+
+    int
+    level_count() const;
+
+    // image data of a mip level, layer is the layer-face index for cube maps;
+    // layer -1 returns the whole level or an empty span if the file does not
+    // store its layers contiguously (DDS arrays and cube maps)
+    std::span<const std::byte>
+    level_data(int level, int layer = -1) const;
+
+    std::shared_ptr<texture>
+    create_texture() const;
+
+    // streams all mip levels present in both file and texture
+    void
+    upload(texture& tex) const;
+
+protected:
+    struct image
+    {
+        int level;
+        int layer;
+        size_t offset;
+        size_t byte_count;
+    };
+
+    // parses without terminating, problems are recorded in error_
+    texture_file(mapped_file file);
+
+    void
+    parse_ktx2_();
+
+    void
+    parse_dds_();
+
+    // records message as error unless condition holds
+    bool
+    check_(bool condition, const std::string& message);
+
+    bool
+    add_image_(int level, int layer, size_t offset, size_t byte_count);
+
+    size_t
+    image_bytes_(int level) const;
+
+protected:
+    mapped_file file_;
+    texture_specification specs_;
+    // pixel type and texel size of uncompressed formats
+    GLenum pixel_type_;
+    size_t texel_bytes_;
+    vec3i_t extent_;
+    int levels_;
+    int layers_;
+    bool array_;
+    std::vector<image> images_;
+    std::string error_;
+};
+
+}  // namespace baldr
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "common.hpp"
+#include "data_buffer.hpp"
+#include "fence.hpp"
+#include "texture.hpp"
+#include "texture_file.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace baldr {
+
+struct image_header
+{
+    int32_t width;
+    int32_t height;
+    uint32_t channels;
+    // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_FLOAT
+    GLenum pixel_type;
+
+    size_t
+    byte_count() const;
+};
+
+// Decodes one image file format on worker threads. decode() writes tightly
+// packed pixels (rows in file order) directly into the upload staging memory.
+// Malformed files are reported by returning nullopt resp. false, which fails
+// the corresponding load instead of terminating.
+class image_decoder
+{
+public:
+    virtual ~image_decoder() = default;
+
+    virtual bool
+    can_decode(const std::filesystem::path& path, std::span<const std::byte> file) const = 0;
+
+    virtual std::optional<image_header>
+    read_header(std::span<const std::byte> file) const = 0;
+
+    virtual bool
+    decode(std::span<const std::byte> file, const image_header& header, std::byte* pixels) const = 0;
+};
+
+// Radiance RGBE (.hdr/.pic), flat or run length encoded, decoded to RGB float
+class radiance_hdr_decoder : public image_decoder
+{
+public:
+    bool
+    can_decode(const std::filesystem::path& path, std::span<const std::byte> file) const override;
+
+    std::optional<image_header>
+    read_header(std::span<const std::byte> file) const override;
+
+    bool
+    decode(std::span<const std::byte> file, const image_header& header, std::byte* pixels) const override;
+};
+
+// binary PGM/PPM (P5/P6) with 8 or 16 bit samples
+class netpbm_decoder : public image_decoder
+{
+public:
+    bool
+    can_decode(const std::filesystem::path& path, std::span<const std::byte> file) const override;
+
+    std::optional<image_header>
+    read_header(std::span<const std::byte> file) const override;
+
+    bool
+    decode(std::span<const std::byte> file, const image_header& header, std::byte* pixels) const override;
+};
+
+struct texture_load_options
+{
+    bool mipmaps = true;
+    bool srgb = false;
+    // overrides the internal format derived from the decoded pixels
+    std::optional<GLenum> internal_format = std::nullopt;
+    std::tuple<GLint, GLint, GLint> wrap_mode = {GL_REPEAT, GL_REPEAT, GL_REPEAT};
+};
+
+// Result of texture_loader::load(), completed during texture_loader::update()
+class pending_texture
+{
+public:
+    pending_texture(std::filesystem::path path);
+
+    const std::filesystem::path&
+    path() const;
+
+    [[nodiscard]]
+    bool
+    ready() const;
+
+    [[nodiscard]]
+    bool
+    failed() const;
+
+    const std::string&
+    error() const;
+
+    // null until ready
+    std::shared_ptr<texture>
+    get() const;
+
+protected:
+    friend class texture_loader;
+
+    std::filesystem::path path_;
+    std::atomic<int> state_;
+    std::shared_ptr<texture> texture_;
+    std::string error_;
+};
+
+// Loads textures asynchronously: files are mapped and decoded on a worker
+// pool, decoded pixels land directly in persistently mapped pixel unpack
+// buffers, and update() creates textures and issues the uploads on the GL
+// thread within a time budget per call. KTX2/DDS files are parsed on the
+// workers and uploaded straight from their file mapping. Additional formats
+// (PNG, JPEG, EXR, ...) are supported by registering decoders.
+class texture_loader
+{
+public:
+    // max_staging_bytes limits the pixel unpack buffer memory of uploads in
+    // flight (single images larger than that are still loaded one at a time)
+    texture_loader(uint32_t worker_count = std::max(2u, std::thread::hardware_concurrency()) - 1, size_t max_staging_bytes = size_t(256) << 20);
+
+    texture_loader(const texture_loader& other) = delete;
+
+    virtual ~texture_loader();
+
+    texture_loader&
+    operator=(const texture_loader& other) = delete;
+
+    // decoders registered later take precedence
+    void
+    add_decoder(std::shared_ptr<image_decoder> decoder);
+
+    std::shared_ptr<pending_texture>
+    load(const std::filesystem::path& path, const texture_load_options& options = {});
+
+    // GL thread only: processes finished decoding steps until the budget is
+    // spent (at least one step per call); returns the number of loads that
+    // finished (successfully or not)
+    size_t
+    update(std::chrono::microseconds budget = std::chrono::microseconds(2000));
+
+    // textures requested but not completed yet
+    size_t
+    pending() const;
+
+protected:
+    enum class stage : int {
+        parse,      // worker: map file, detect format, read header
+        allocate,   // GL: create texture and assign staging memory
+        decode,     // worker: decode into staging memory
+        upload,     // GL: upload from staging memory
+        container   // GL: create texture from a parsed KTX2/DDS file
+    };
+
+    struct staging
+    {
+        std::unique_ptr<data_buffer> buffer;
+        std::byte* mapping;
+        std::optional<fence> upload;
+        bool in_use;
+    };
+
+    struct job
+    {
+        stage next;
+        texture_load_options options;
+        std::shared_ptr<pending_texture> result;
+        std::optional<mapped_file> file;
+        std::unique_ptr<texture_file> container;
+        std::shared_ptr<image_decoder> decoder;
+        image_header header;
+        std::shared_ptr<texture> tex;
+        staging* slot = nullptr;
+        // set by workers, reported on the GL thread
+        std::string error;
+    };
+
+    void
+    work_();
+
+    void
+    parse_(job& j);
+
+    // returns false if the job has to wait for staging memory
+    bool
+    process_(const std::shared_ptr<job>& j);
+
+    staging*
+    acquire_staging_(size_t byte_count);
+
+    // releases idle staging buffers whose uploads completed
+    void
+    trim_staging_();
+
+    void
+    finish_(job& j);
+
+protected:
+    std::vector<std::shared_ptr<image_decoder>> decoders_;
+    size_t max_staging_bytes_;
+    std::vector<std::unique_ptr<staging>> staging_;
+    resource_registry::evictor_id evictor_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::deque<std::shared_ptr<job>> work_queue_;
+    std::deque<std::shared_ptr<job>> gl_queue_;
+    std::atomic<size_t> pending_;
+    bool stop_;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace baldr
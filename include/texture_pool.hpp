@@ -0,0 +1,89 @@
+#pragma once
+
+#include "common.hpp"
+#include "texture.hpp"
+
+namespace baldr {
+
+struct texture_pool_statistics
+{
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    // textures currently handed out resp. waiting for reuse
+    size_t leased = 0;
+    size_t pooled = 0;
+};
+
+// Recycles transient textures (e.g. post-processing targets) between frames.
+// acquire() returns a lease in form of a shared_ptr whose deleter hands the
+// texture back to the pool instead of deleting it; textures that have not
+// been reused for max_idle_frames calls to next_frame() are deleted.
+class texture_pool
+{
+public:
+    texture_pool(uint32_t max_idle_frames = 3);
+
+    texture_pool(const texture_pool& other) = delete;
+
+    virtual ~texture_pool();
+
+    texture_pool&
+    operator=(const texture_pool& other) = delete;
+
+    [[nodiscard]]
+    std::shared_ptr<texture>
+    acquire(int32_t width, const texture_specification& specs);
+
+    [[nodiscard]]
+    std::shared_ptr<texture>
+    acquire(int32_t width, int32_t height, const texture_specification& specs);
+
+    [[nodiscard]]
+    std::shared_ptr<texture>
+    acquire(int32_t width, int32_t height, int32_t depth, const texture_specification& specs);
+
+    // advances the frame counter and trims textures idle for too long
+    void
+    next_frame();
+
+    // deletes all pooled (not leased) textures, returns the number deleted
+    size_t
+    trim();
+
+    texture_pool_statistics
+    statistics() const;
+
+protected:
+    struct key
+    {
+        vec3i_t size;
+        texture_specification specs;
+
+        bool operator<(const key& other) const;
+    };
+
+    struct entry
+    {
+        std::unique_ptr<texture> tex;
+        uint64_t last_used;
+    };
+
+    struct state
+    {
+        uint64_t frame = 0;
+        uint32_t max_idle_frames;
+        std::multimap<key, entry> pooled;
+        texture_pool_statistics stats;
+    };
+
+    std::shared_ptr<texture>
+    acquire_(const vec3i_t& size, const texture_specification& specs);
+
+protected:
+    // shared with the lease deleters so leases may outlive the pool
+    std::shared_ptr<state> state_;
+    resource_registry::evictor_id evictor_;
+};
+
+}  // namespace baldr
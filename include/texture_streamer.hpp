@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstring>
+
+#include "common.hpp"
+#include "streaming_buffer.hpp"
+#include "texture.hpp"
+
+namespace baldr {
+
+// Ring of persistently mapped pixel unpack buffer slots for texture uploads.
+// A slot obtained by reserve() on the GL thread may be filled from any
+// thread; submit() (GL thread again) issues the glTextureSubImage* call
+// sourcing the slot and fences it so it is recycled once the GPU consumed it.
+class texture_streamer
+{
+public:
+    texture_streamer(GLuint slot_byte_count, GLuint slot_count = 4);
+
+    texture_streamer(const texture_streamer& other) = delete;
+
+    virtual ~texture_streamer();
+
+    texture_streamer&
+    operator=(const texture_streamer& other) = delete;
+
+    GLuint
+    slot_byte_count() const;
+
+    GLuint
+    slot_count() const;
+
+    // waits until the next slot has been released by the GPU
+    [[nodiscard]]
+    streaming_region
+    reserve();
+
+    void
+    submit(texture& tex, const streaming_region& slot, GLenum pixel_type, int level = 0);
+
+    template <typename T>
+    void
+    submit(texture& tex, const streaming_region& slot, int level = 0);
+
+    // returns a reserved slot without uploading from it
+    void
+    cancel(const streaming_region& slot);
+
+protected:
+    streaming_buffer ring_;
+    std::vector<bool> reserved_;
+};
+
+}  // namespace baldr
+
+#include "texture_streamer.ipp"
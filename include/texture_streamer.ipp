@@ -0,0 +1,9 @@
+namespace baldr {
+
+template <typename T>
+inline void
+texture_streamer::submit(texture& tex, const streaming_region& slot, int level) {
+    submit(tex, slot, detail::pixel_type<T>(), level);
+}
+
+}  // namespace baldr
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "common.hpp"
+#include "data_buffer.hpp"
+#include "sampler.hpp"
+#include "shader_program.hpp"
+#include "texture.hpp"
+
+namespace baldr {
+
+// Indexable set of textures for material-heavy draws. With
+// ARB_bindless_texture the resident handles are stored in an SSBO, otherwise
+// the textures are bound to consecutive units of a sampler array. Shaders
+// include glsl_declaration() and sample via name(index) in both modes.
+class texture_table
+{
+public:
+    // force_units disables bindless handles even if they are supported
+    texture_table(uint32_t capacity, bool force_units = false);
+
+    texture_table(const texture_table& other) = delete;
+
+    virtual ~texture_table();
+
+    texture_table&
+    operator=(const texture_table& other) = delete;
+
+    bool
+    bindless() const;
+
+    uint32_t
+    capacity() const;
+
+    uint32_t
+    size() const;
+
+    // returns the index of the texture in the table
+    uint32_t
+    add(std::shared_ptr<texture> tex, std::shared_ptr<sampler> smp = nullptr);
+
+    void
+    set(uint32_t index, std::shared_ptr<texture> tex, std::shared_ptr<sampler> smp = nullptr);
+
+    void
+    clear();
+
+    // declarations defining name(index) as a sampler_type; has to follow the
+    // #version directive directly since it may enable the bindless extension
+    std::string
+    glsl_declaration(const std::string& name, const std::string& sampler_type = "sampler2D") const;
+
+    // uploads changed handles resp. binds all textures to the units of the
+    // sampler array declared for name
+    void
+    bind(const shader_program& program, const std::string& name);
+
+protected:
+    struct entry
+    {
+        std::shared_ptr<texture> tex;
+        std::shared_ptr<sampler> smp;
+    };
+
+    void
+    release_(entry& e);
+
+protected:
+    bool bindless_;
+    uint32_t capacity_;
+    std::vector<entry> entries_;
+    std::vector<GLuint64> handles_;
+    std::unique_ptr<data_buffer> handle_buffer_;
+    bool dirty_;
+};
+
+}  // namespace baldr
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "common.hpp"
+#include "texture.hpp"
+
+namespace baldr {
+
+// compile-time description of an uncompressed internal format
+template <GLenum InternalFormat>
+struct texture_format;
+
+#define BALDR_TEXTURE_FORMAT(internal, pixel_format, component, count) \
+    template <>                                                          \
+    struct texture_format<internal>                                      \
+    {                                                                    \
+        using component_type = component;                               \
+        static constexpr GLenum internal_format = internal;             \
+        static constexpr GLenum format = pixel_format;                  \
+        static constexpr uint32_t channels = count;                     \
+    };
+
+BALDR_TEXTURE_FORMAT(GL_R8, GL_RED, uint8_t, 1)
+BALDR_TEXTURE_FORMAT(GL_RG8, GL_RG, uint8_t, 2)
+BALDR_TEXTURE_FORMAT(GL_RGB8, GL_RGB, uint8_t, 3)
+BALDR_TEXTURE_FORMAT(GL_RGBA8, GL_RGBA, uint8_t, 4)
+BALDR_TEXTURE_FORMAT(GL_SRGB8_ALPHA8, GL_RGBA, uint8_t, 4)
+BALDR_TEXTURE_FORMAT(GL_R8UI, GL_RED_INTEGER, uint8_t, 1)
+BALDR_TEXTURE_FORMAT(GL_RGB8UI, GL_RGB_INTEGER, uint8_t, 3)
+BALDR_TEXTURE_FORMAT(GL_RGBA8UI, GL_RGBA_INTEGER, uint8_t, 4)
+BALDR_TEXTURE_FORMAT(GL_R16UI, GL_RED_INTEGER, uint16_t, 1)
+BALDR_TEXTURE_FORMAT(GL_R32UI, GL_RED_INTEGER, uint32_t, 1)
+BALDR_TEXTURE_FORMAT(GL_RG32UI, GL_RG_INTEGER, uint32_t, 2)
+BALDR_TEXTURE_FORMAT(GL_RGBA32UI, GL_RGBA_INTEGER, uint32_t, 4)
+BALDR_TEXTURE_FORMAT(GL_R32I, GL_RED_INTEGER, int32_t, 1)
+BALDR_TEXTURE_FORMAT(GL_RGBA32I, GL_RGBA_INTEGER, int32_t, 4)
+BALDR_TEXTURE_FORMAT(GL_R32F, GL_RED, float, 1)
+BALDR_TEXTURE_FORMAT(GL_RG32F, GL_RG, float, 2)
+BALDR_TEXTURE_FORMAT(GL_RGB32F, GL_RGB, float, 3)
+BALDR_TEXTURE_FORMAT(GL_RGBA32F, GL_RGBA, float, 4)
+BALDR_TEXTURE_FORMAT(GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, float, 1)
+
+#undef BALDR_TEXTURE_FORMAT
+
+template <GLenum InternalFormat>
+struct texture_format_traits : texture_format<InternalFormat>
+{
+    using base = texture_format<InternalFormat>;
+    using typename base::component_type;
+
+    static constexpr GLenum pixel_type = detail::pixel_type<component_type>();
+    static constexpr size_t pixel_bytes = base::channels * sizeof(component_type);
+};
+
+// Texture whose format and dimensionality are part of the type: transfers
+// only accept spans of the format's component type, pixel types are
+// resolved at compile time and buffer sizes are checked against the exact
+// level size.
+template <GLenum InternalFormat, int Dim>
+class typed_texture : public texture
+{
+public:
+    static_assert(Dim >= 1 && Dim <= 3, "typed_texture supports 1 to 3 dimensions");
+
+    using traits = texture_format_traits<InternalFormat>;
+    using component_type = typename traits::component_type;
+    using pixel = std::array<component_type, traits::channels>;
+
+    explicit typed_texture(const std::array<int32_t, Dim>& size, GLuint levels = 1);
+
+    static std::shared_ptr<typed_texture>
+    create(const std::array<int32_t, Dim>& size, GLuint levels = 1);
+
+    // number of components (not pixels) of a level
+    size_t
+    element_count(int level = 0) const;
+
+    void
+    set(std::span<const component_type> data, int level = 0);
+
+    void
+    set(std::span<const component_type> data, const texture_region& region, int level = 0);
+
+    void
+    get(std::span<component_type> data, int level = 0) const;
+
+    std::vector<component_type>
+    get(int level = 0) const;
+
+    void
+    clear(const pixel& value, int level = 0);
+
+protected:
+    template <size_t... Is>
+    typed_texture(const std::array<int32_t, Dim>& size, GLuint levels, std::index_sequence<Is...>);
+
+    static texture_specification
+    specification_(GLuint levels);
+};
+
+using texture_r8 = typed_texture<GL_R8, 2>;
+using texture_rgba8 = typed_texture<GL_RGBA8, 2>;
+using texture_rgba8ui = typed_texture<GL_RGBA8UI, 2>;
+using texture_r32f = typed_texture<GL_R32F, 2>;
+using texture_rgba32f = typed_texture<GL_RGBA32F, 2>;
+using texture_depth32f = typed_texture<GL_DEPTH_COMPONENT32F, 2>;
+
+}  // namespace baldr
+
+#include "typed_texture.ipp"
@@ -0,0 +1,71 @@
+namespace baldr {
+
+template <GLenum InternalFormat, int Dim>
+inline
+typed_texture<InternalFormat, Dim>::typed_texture(const std::array<int32_t, Dim>& size, GLuint levels) : typed_texture(size, levels, std::make_index_sequence<Dim>()) {
+}
+
+template <GLenum InternalFormat, int Dim>
+template <size_t... Is>
+inline
+typed_texture<InternalFormat, Dim>::typed_texture(const std::array<int32_t, Dim>& size, GLuint levels, std::index_sequence<Is...>) : texture(size[Is]..., specification_(levels)) {
+}
+
+template <GLenum InternalFormat, int Dim>
+inline std::shared_ptr<typed_texture<InternalFormat, Dim>>
+typed_texture<InternalFormat, Dim>::create(const std::array<int32_t, Dim>& size, GLuint levels) {
+    return std::make_shared<typed_texture>(size, levels);
+}
+
+template <GLenum InternalFormat, int Dim>
+inline size_t
+typed_texture<InternalFormat, Dim>::element_count(int level) const {
+    return static_cast<size_t>(level_size(level).prod()) * traits::channels;
+}
+
+template <GLenum InternalFormat, int Dim>
+inline void
+typed_texture<InternalFormat, Dim>::set(std::span<const component_type> data, int level) {
+    set(data, level_region(level), level);
+}
+
+template <GLenum InternalFormat, int Dim>
+inline void
+typed_texture<InternalFormat, Dim>::set(std::span<const component_type> data, const texture_region& region, int level) {
+    terminate_unless(data.size() == static_cast<size_t>(region.extent.prod()) * traits::channels, "Texture upload size mismatch (expected {} components, got {})", region.extent.prod() * traits::channels, data.size());
+    set_region_(data.data(), region, level, traits::pixel_type, 0, 0);
+}
+
+template <GLenum InternalFormat, int Dim>
+inline void
+typed_texture<InternalFormat, Dim>::get(std::span<component_type> data, int level) const {
+    terminate_unless(data.size() == element_count(level), "Texture download size mismatch (expected {} components, got {})", element_count(level), data.size());
+    // element_count() assumes tightly packed rows
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTextureImage(handle_, level, traits::format, traits::pixel_type, data.size_bytes(), data.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+}
+
+template <GLenum InternalFormat, int Dim>
+inline std::vector<typename typed_texture<InternalFormat, Dim>::component_type>
+typed_texture<InternalFormat, Dim>::get(int level) const {
+    std::vector<component_type> data(element_count(level));
+    get(std::span<component_type>(data), level);
+    return data;
+}
+
+template <GLenum InternalFormat, int Dim>
+inline void
+typed_texture<InternalFormat, Dim>::clear(const pixel& value, int level) {
+    glClearTexImage(handle_, level, traits::format, traits::pixel_type, value.data());
+}
+
+template <GLenum InternalFormat, int Dim>
+inline texture_specification
+typed_texture<InternalFormat, Dim>::specification_(GLuint levels) {
+    texture_specification specs{traits::format, InternalFormat};
+    specs.levels = levels;
+    return specs;
+}
+
+}  // namespace baldr
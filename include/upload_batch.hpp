@@ -0,0 +1,103 @@
+#pragma once
+
+#include "common.hpp"
+#include "data_buffer.hpp"
+#include "streaming_buffer.hpp"
+#include "texture.hpp"
+
+namespace baldr {
+
+struct upload_statistics
+{
+    size_t bytes = 0;
+    // number of set_data()/set() calls recorded
+    size_t requested_calls = 0;
+    // number of copy/upload calls actually issued
+    size_t issued_calls = 0;
+
+    size_t
+    saved_calls() const;
+};
+
+// Accumulates many small buffer and texture writes into one staging region
+// and issues them at flush() with as few copy commands as possible.
+// Destination objects must stay alive (and must not be reallocated) until
+// the batch has been flushed.
+class upload_batch
+{
+public:
+    upload_batch(GLuint staging_byte_count = 16u << 20, GLuint region_count = 3);
+
+    upload_batch(const upload_batch& other) = delete;
+
+    virtual ~upload_batch();
+
+    upload_batch&
+    operator=(const upload_batch& other) = delete;
+
+    void
+    set_data(data_buffer& buffer, const void* data, GLintptr offset, GLsizeiptr byte_count);
+
+    template <typename T>
+    void
+    set_data(data_buffer& buffer, std::span<const T> data, GLuint first = 0);
+
+    template <typename T>
+    void
+    set(texture& tex, const T* data, int level = 0);
+
+    // issues all pending copies, typically right before render_pass::render
+    void
+    flush();
+
+    [[nodiscard]]
+    bool
+    empty() const;
+
+    // statistics of the last flush() resp. accumulated since construction
+    const upload_statistics&
+    last_statistics() const;
+
+    const upload_statistics&
+    total_statistics() const;
+
+protected:
+    struct buffer_copy
+    {
+        data_buffer* buffer;
+        GLintptr src_offset;
+        GLintptr dst_offset;
+        GLsizeiptr byte_count;
+    };
+
+    struct texture_upload
+    {
+        texture* tex;
+        GLintptr src_offset;
+        GLenum pixel_type;
+        int level;
+    };
+
+    void
+    issue_();
+
+    void
+    set_(texture& tex, const void* data, GLsizeiptr byte_count, GLuint value_size, GLenum pixel_type, int level);
+
+    GLintptr
+    stage_(const void* data, GLsizeiptr byte_count, GLuint alignment);
+
+protected:
+    streaming_buffer staging_;
+    bool acquired_;
+    // copies are kept in recording order so that overlapping writes resolve
+    // like immediate uploads would; only directly adjacent writes are merged
+    std::vector<std::variant<buffer_copy, texture_upload>> pending_;
+    upload_statistics current_;
+    upload_statistics last_;
+    upload_statistics total_;
+};
+
+}  // namespace baldr
+
+#include "upload_batch.ipp"
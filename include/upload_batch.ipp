@@ -0,0 +1,22 @@
+namespace baldr {
+
+inline size_t
+upload_statistics::saved_calls() const {
+    return requested_calls > issued_calls ? requested_calls - issued_calls : 0;
+}
+
+template <typename T>
+inline void
+upload_batch::set_data(data_buffer& buffer, std::span<const T> data, GLuint first) {
+    set_data(buffer, reinterpret_cast<const void*>(data.data()), first * sizeof(T), data.size_bytes());
+}
+
+template <typename T>
+inline void
+upload_batch::set(texture& tex, const T* data, int level) {
+    vec3i_t size = tex.level_size(level);
+    GLsizeiptr byte_count = static_cast<GLsizeiptr>(size.prod()) * tex.channel_count() * sizeof(T);
+    set_(tex, reinterpret_cast<const void*>(data), byte_count, sizeof(T), detail::pixel_type<T>(), level);
+}
+
+}  // namespace baldr
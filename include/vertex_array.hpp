@@ -2,6 +2,7 @@
 
 #include "common.hpp"
 #include "data_buffer.hpp"
+#include "buffer_arena.hpp"
 
 namespace baldr {
 
@@ -21,6 +22,12 @@ struct binding_point {
 
     const binding_point&
     operator=(const data_buffer& buffer) const;
+
+    const binding_point&
+    operator=(const buffer_allocation& allocation) const;
+
+    void
+    bind(const data_buffer& buffer, GLintptr offset) const;
 };
 
 class vertex_array
@@ -36,7 +43,15 @@ public:
 
     static void release();
 
-    void set_index_buffer(std::shared_ptr<const data_buffer> ibo);
+    void set_index_buffer(std::shared_ptr<const data_buffer> ibo, GLintptr offset = 0);
+
+    void set_index_buffer(const buffer_allocation& allocation);
+
+    [[nodiscard]] GLintptr index_offset() const;
+
+    // indexed draw of the bound vertex array sourcing indices from the index
+    // buffer offset plus first_index
+    void draw_elements(GLenum mode, GLsizei count, GLenum index_type, GLuint first_index = 0, GLint base_vertex = 0, GLsizei instances = 1) const;
 
     [[nodiscard]] binding_point
     vertex_buffer_binding(const std::vector<vertex_attribute>& attributes, GLuint vertex_stride);
@@ -45,6 +60,7 @@ protected:
     GLuint handle_;
     GLuint next_binding_point_;
     std::shared_ptr<const data_buffer> ibo_;
+    GLintptr ibo_offset_;
 };
 
 }  // namespace baldr
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "common.hpp"
+#include "data_buffer.hpp"
+#include "dirty_regions.hpp"
+#include "readback.hpp"
+#include "shader_program.hpp"
+#include "texture.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace baldr {
+
+struct virtual_texture_specification
+{
+    // size of the finest level in pixels; width and height divided by
+    // tile_size have to be powers of two of at most 2048 (the page table is
+    // mirrored on the CPU)
+    int32_t width;
+    int32_t height;
+    int32_t tile_size = 128;
+    // filtering border around each tile (included in the provided tile data)
+    int32_t border = 4;
+    // capacity of the physical atlas in tiles per side (at most 256)
+    int32_t atlas_tiles = 32;
+    GLenum format = GL_RGBA;
+    GLenum internal_format = GL_RGBA8;
+    GLenum pixel_type = GL_UNSIGNED_BYTE;
+    // maximum number of tile requests recorded per frame
+    uint32_t feedback_capacity = 1 << 16;
+    // one of feedback_rate x feedback_rate pixels records its tile per frame
+    uint32_t feedback_rate = 4;
+};
+
+struct virtual_tile
+{
+    uint32_t level;
+    uint32_t x;
+    uint32_t y;
+};
+
+struct virtual_texture_statistics
+{
+    // distinct tiles requested by feedback resp. not resident when requested
+    size_t requests = 0;
+    size_t misses = 0;
+    size_t loads = 0;
+    size_t evictions = 0;
+    size_t failures = 0;
+    // tiles in the atlas resp. queued or being loaded
+    size_t resident = 0;
+    size_t pending = 0;
+    size_t capacity = 0;
+};
+
+// Software virtual texturing: a mip-mapped virtual image is split into tiles
+// of which only those visible are kept in a physical atlas texture. The page
+// table texture maps every virtual tile to its atlas slot or, if not
+// resident, to the slot of its nearest resident ancestor. Fragment shaders
+// sampling via glsl_declaration() record the tiles they need in a feedback
+// buffer; update() reads it back asynchronously, streams missing tiles from
+// the tile provider on worker threads and replaces least recently used tiles.
+// The coarsest tile is never evicted so every lookup has a fallback.
+class virtual_texture
+{
+public:
+    // fills pixels (tightly packed, (tile_size + 2 * border)^2 texels) for
+    // the given tile; called on worker threads, returns false on failure
+    using tile_provider = std::function<bool(const virtual_tile& tile, std::span<std::byte> pixels)>;
+
+    virtual_texture(const virtual_texture_specification& specs, tile_provider provider, uint32_t worker_count = 2);
+
+    virtual_texture(const virtual_texture& other) = delete;
+
+    virtual ~virtual_texture();
+
+    virtual_texture&
+    operator=(const virtual_texture& other) = delete;
+
+    // reads tiles from a pre-tiled raw file: levels from finest to coarsest,
+    // tiles row by row within a level, each tile stored with its border
+    static tile_provider
+    file_provider(const std::filesystem::path& path, const virtual_texture_specification& specs);
+
+    const virtual_texture_specification&
+    specification() const;
+
+    int
+    level_count() const;
+
+    // number of tiles in x and y direction at the given level
+    vec2i_t
+    level_tiles(int level) const;
+
+    size_t
+    tile_byte_count() const;
+
+    const texture&
+    atlas() const;
+
+    const texture&
+    page_table() const;
+
+    // whether the coarsest tile is resident (lookups return black before)
+    bool
+    ready() const;
+
+    bool
+    resident(const virtual_tile& tile) const;
+
+    // declares vec4 name(vec2 uv) sampling the virtual texture and recording
+    // feedback; for fragment shaders only (requires GLSL 4.30). the feedback
+    // buffer has no explicit binding, shader_program gives name_feedback a
+    // binding point of its own which bind() uses
+    std::string
+    glsl_declaration(const std::string& name) const;
+
+    void
+    bind(const shader_program& program, const std::string& name) const;
+
+    // call once per frame after the draws sampling the texture: processes
+    // finished feedback readbacks, requests missing tiles, uploads up to
+    // max_uploads loaded tiles and updates the page table
+    void
+    update(uint32_t max_uploads = 16);
+
+    virtual_texture_statistics
+    statistics() const;
+
+protected:
+    struct cache_entry
+    {
+        uint32_t slot;
+        std::list<uint32_t>::iterator lru;
+        uint64_t last_used;
+    };
+
+    struct loaded_tile
+    {
+        uint32_t key;
+        std::vector<std::byte> pixels;
+        bool valid;
+    };
+
+    void
+    work_();
+
+    bool
+    valid_key_(uint32_t key) const;
+
+    bool
+    touch_(uint32_t key);
+
+    void
+    process_feedback_(std::span<const uint32_t> requests);
+
+    void
+    upload_tiles_(uint32_t max_uploads);
+
+    // returns a free atlas slot, evicting the least recently used tile not
+    // requested by the latest feedback if necessary
+    std::optional<uint32_t>
+    allocate_slot_();
+
+    // marks the page table entries covered by tile in its own and all finer
+    // levels, since their fallback may have changed
+    void
+    mark_dirty_(const virtual_tile& tile);
+
+    void
+    update_page_table_();
+
+protected:
+    virtual_texture_specification specs_;
+    tile_provider provider_;
+    int levels_;
+    size_t tile_bytes_;
+    std::unique_ptr<texture> atlas_;
+    std::unique_ptr<texture> page_table_;
+    std::unique_ptr<data_buffer> feedback_;
+    std::deque<readback> feedback_reads_;
+    uint32_t phase_;
+
+    // GL thread state
+    uint32_t root_;
+    std::unordered_map<uint32_t, cache_entry> cache_;
+    std::list<uint32_t> lru_;
+    std::vector<uint32_t> free_slots_;
+    std::unordered_set<uint32_t> pending_;
+    uint64_t epoch_;
+    // per level: atlas slot + 1 of resident tiles and RGBA8UI page table entries
+    std::vector<std::vector<uint32_t>> resident_;
+    std::vector<std::vector<uint8_t>> table_;
+    // page table entries to recompute and upload per level
+    std::vector<dirty_regions> dirty_;
+    virtual_texture_statistics stats_;
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::deque<uint32_t> requests_;
+    std::deque<loaded_tile> loaded_;
+    bool stop_;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace baldr
@@ -0,0 +1,120 @@
+#include <buffer_arena.hpp>
+
+namespace {
+
+GLintptr
+align_up(GLintptr value, GLuint alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+namespace baldr {
+
+buffer_arena::buffer_arena(GLsizeiptr block_byte_count, immutable_storage storage) : block_byte_count_(block_byte_count), storage_(storage), allocated_bytes_(0) {
+}
+
+buffer_arena::~buffer_arena() {
+}
+
+buffer_allocation
+buffer_arena::allocate(GLsizeiptr byte_count, GLuint alignment) {
+    if (!alignment) {
+        alignment = data_buffer::offset_alignment();
+    }
+
+    for (GLuint i = 0; i < blocks_.size(); ++i) {
+        if (auto allocation = allocate_from_(i, byte_count, alignment)) {
+            return *allocation;
+        }
+    }
+
+    // oversized requests get a dedicated block
+    GLsizeiptr size = std::max(block_byte_count_, byte_count);
+    block new_block;
+    new_block.buffer = std::make_shared<data_buffer>(static_cast<GLuint>(size), storage_);
+    new_block.free_ranges[0] = size;
+    blocks_.push_back(std::move(new_block));
+
+    auto allocation = allocate_from_(blocks_.size() - 1, byte_count, alignment);
+    terminate_unless(allocation.has_value(), "Unable to allocate {} bytes from fresh arena block", byte_count);
+    return *allocation;
+}
+
+void
+buffer_arena::free(const buffer_allocation& allocation) {
+    if (!allocation) return;
+
+    terminate_unless(allocation.block < blocks_.size() && blocks_[allocation.block].buffer == allocation.buffer, "Trying to free allocation not owned by this arena");
+    auto& ranges = blocks_[allocation.block].free_ranges;
+
+    GLintptr begin = allocation.offset;
+    GLintptr end = allocation.offset + allocation.byte_count;
+
+    // coalesce with the following free range
+    auto next = ranges.lower_bound(begin);
+    if (next != ranges.end() && next->first == end) {
+        end += next->second;
+        next = ranges.erase(next);
+    }
+
+    // coalesce with the preceding free range
+    if (next != ranges.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == begin) {
+            prev->second = end - prev->first;
+            allocated_bytes_ -= allocation.byte_count;
+            return;
+        }
+    }
+
+    ranges[begin] = end - begin;
+    allocated_bytes_ -= allocation.byte_count;
+}
+
+GLuint
+buffer_arena::block_count() const {
+    return blocks_.size();
+}
+
+GLsizeiptr
+buffer_arena::allocated_bytes() const {
+    return allocated_bytes_;
+}
+
+GLsizeiptr
+buffer_arena::reserved_bytes() const {
+    GLsizeiptr bytes = 0;
+    for (const auto& b : blocks_) {
+        bytes += b.buffer->byte_count();
+    }
+    return bytes;
+}
+
+std::optional<buffer_allocation>
+buffer_arena::allocate_from_(GLuint block_index, GLsizeiptr byte_count, GLuint alignment) {
+    auto& b = blocks_[block_index];
+    for (auto it = b.free_ranges.begin(); it != b.free_ranges.end(); ++it) {
+        auto [range_offset, range_size] = *it;
+        GLintptr offset = align_up(range_offset, alignment);
+        GLintptr range_end = range_offset + range_size;
+        if (offset + byte_count > range_end) {
+            continue;
+        }
+
+        b.free_ranges.erase(it);
+        if (offset > range_offset) {
+            b.free_ranges[range_offset] = offset - range_offset;
+        }
+        if (offset + byte_count < range_end) {
+            b.free_ranges[offset + byte_count] = range_end - (offset + byte_count);
+        }
+
+        allocated_bytes_ += byte_count;
+        return buffer_allocation{b.buffer, offset, byte_count, block_index};
+    }
+
+    return std::nullopt;
+}
+
+} // baldr
@@ -2,15 +2,34 @@
 
 namespace baldr {
 
-data_buffer::data_buffer(GLuint byte_count, GLenum usage_hint, const void* data) : allocated_(false), byte_count_(byte_count), usage_hint_(usage_hint) {
+// zero-sized storage is an error, growable buffers keep room for one word
+constexpr GLuint min_capacity = sizeof(GLuint);
+
+data_buffer::data_buffer(GLuint byte_count, GLenum usage_hint, const void* data) : allocated_(false), immutable_(false), byte_count_(byte_count), capacity_(byte_count), usage_hint_(usage_hint), storage_flags_(0) {
+    resource_id_ = resource_registry::instance().add(resource_category::buffer, byte_count);
     glCreateBuffers(1, &handle_);
     set_data(data);
 }
 
+data_buffer::data_buffer(GLuint byte_count, immutable_storage storage, const void* data) : allocated_(true), immutable_(true), byte_count_(byte_count), capacity_(byte_count), usage_hint_(GL_NONE), storage_flags_(storage.flags) {
+    resource_id_ = resource_registry::instance().add(resource_category::buffer, byte_count);
+    glCreateBuffers(1, &handle_);
+    glNamedBufferStorage(handle_, byte_count_, data, storage_flags_);
+}
+
 data_buffer::~data_buffer() {
+    resource_registry::instance().remove(resource_id_);
     glDeleteBuffers(1, &handle_);
 }
 
+GLuint
+data_buffer::offset_alignment() {
+    GLint ubo_alignment = 1, ssbo_alignment = 1;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ubo_alignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssbo_alignment);
+    return static_cast<GLuint>(std::max({ubo_alignment, ssbo_alignment, 1}));
+}
+
 GLuint
 data_buffer::handle() const {
     return handle_;
@@ -21,6 +40,50 @@ data_buffer::byte_count() const {
     return byte_count_;
 }
 
+GLuint
+data_buffer::capacity() const {
+    return capacity_;
+}
+
+void
+data_buffer::reserve(GLuint byte_count) {
+    if (byte_count > capacity_) {
+        reallocate_(byte_count);
+    }
+}
+
+void
+data_buffer::resize(GLuint byte_count) {
+    if (byte_count > capacity_) {
+        reallocate_(std::max(byte_count, 2 * capacity_));
+    }
+    byte_count_ = byte_count;
+}
+
+void
+data_buffer::append(const void* data, GLuint byte_count) {
+    GLuint offset = byte_count_;
+    resize(byte_count_ + byte_count);
+    set_data(data, offset, byte_count);
+}
+
+void
+data_buffer::shrink_to_fit() {
+    if (capacity_ > std::max(byte_count_, min_capacity)) {
+        reallocate_(byte_count_);
+    }
+}
+
+bool
+data_buffer::immutable() const {
+    return immutable_;
+}
+
+GLbitfield
+data_buffer::storage_flags() const {
+    return storage_flags_;
+}
+
 void
 data_buffer::set_data(const void* data) {
     if (!allocated_) {
@@ -32,6 +95,16 @@ data_buffer::set_data(const void* data) {
     glNamedBufferSubData(handle_, 0, byte_count_, data);
 }
 
+void
+data_buffer::set_data(const void* data, GLintptr offset, GLsizeiptr byte_count) {
+    terminate_unless(offset >= 0 && offset + byte_count <= byte_count_, "Buffer upload range [{}, {}) exceeds buffer size {}", offset, offset + byte_count, byte_count_);
+    if (!data || !byte_count) {
+        return;
+    }
+
+    glNamedBufferSubData(handle_, offset, byte_count, data);
+}
+
 void
 data_buffer::get_data(void* data) const {
     get_data(data, byte_count_);
@@ -39,12 +112,34 @@ data_buffer::get_data(void* data) const {
 
 void
 data_buffer::get_data(void* data, GLuint byte_count) const {
-    if (!allocated_) {
+    get_data(data, 0, byte_count);
+}
+
+void
+data_buffer::get_data(void* data, GLintptr offset, GLsizeiptr byte_count) const {
+    terminate_unless(offset >= 0 && offset + byte_count <= byte_count_, "Buffer download range [{}, {}) exceeds buffer size {}", offset, offset + byte_count, byte_count_);
+    if (!allocated_ || !byte_count) {
         return;
     }
 
-    memcpy(data, map(GL_MAP_READ_BIT), byte_count);
-    unmap();
+    // unlike a read mapping this only transfers the requested range and also
+    // works for immutable storage without GL_MAP_READ_BIT
+    glGetNamedBufferSubData(handle_, offset, byte_count, data);
+}
+
+readback
+data_buffer::read_async(GLintptr offset, GLsizeiptr byte_count) const {
+    terminate_unless(offset >= 0 && offset + byte_count <= byte_count_, "Buffer readback range [{}, {}) exceeds buffer size {}", offset, offset + byte_count, byte_count_);
+    detail::staging_buffer staging = detail::acquire_staging_buffer(byte_count);
+    if (byte_count) {
+        glCopyNamedBufferSubData(handle_, staging.buffer->handle(), offset, 0, byte_count);
+    }
+    return readback(std::move(staging), byte_count);
+}
+
+readback
+data_buffer::read_async() const {
+    return read_async(0, byte_count_);
 }
 
 void*
@@ -57,14 +152,63 @@ data_buffer::map(GLbitfield access) const {
     return glMapNamedBufferRange(handle_, 0, byte_count_, access);
 }
 
+void*
+data_buffer::map(GLbitfield access, GLintptr offset, GLsizeiptr byte_count) {
+    terminate_unless(offset >= 0 && offset + byte_count <= byte_count_, "Buffer map range [{}, {}) exceeds buffer size {}", offset, offset + byte_count, byte_count_);
+    return glMapNamedBufferRange(handle_, offset, byte_count, access);
+}
+
+const void*
+data_buffer::map(GLbitfield access, GLintptr offset, GLsizeiptr byte_count) const {
+    terminate_unless(offset >= 0 && offset + byte_count <= byte_count_, "Buffer map range [{}, {}) exceeds buffer size {}", offset, offset + byte_count, byte_count_);
+    return glMapNamedBufferRange(handle_, offset, byte_count, access);
+}
+
 void
 data_buffer::unmap() const {
     glUnmapNamedBuffer(handle_);
 }
 
+void
+data_buffer::reallocate_(GLuint capacity) {
+    terminate_unless(!(storage_flags_ & GL_MAP_PERSISTENT_BIT), "Persistently mapped buffers cannot be reallocated");
+    capacity = std::max(capacity, min_capacity);
+    resource_registry::instance().resize(resource_id_, capacity);
+
+    GLuint new_handle;
+    glCreateBuffers(1, &new_handle);
+    if (immutable_) {
+        glNamedBufferStorage(new_handle, capacity, nullptr, storage_flags_);
+    } else {
+        glNamedBufferData(new_handle, capacity, nullptr, usage_hint_);
+    }
+
+    GLuint preserved = std::min(byte_count_, capacity);
+    if (allocated_ && preserved) {
+        glCopyNamedBufferSubData(handle_, new_handle, 0, 0, preserved);
+    }
+
+    glDeleteBuffers(1, &handle_);
+    handle_ = new_handle;
+    capacity_ = capacity;
+    allocated_ = true;
+}
+
+void
+data_buffer::tag(const std::string& tag) {
+    resource_registry::instance().tag(resource_id_, tag);
+}
+
 void
 data_buffer::clear_to_zero() {
     glClearNamedBufferData(handle_, GL_R32UI, GL_RED, GL_UNSIGNED_INT, nullptr);
 }
 
+void
+data_buffer::clear_to_zero(GLintptr offset, GLsizeiptr byte_count) {
+    terminate_unless(offset >= 0 && offset + byte_count <= byte_count_, "Buffer clear range [{}, {}) exceeds buffer size {}", offset, offset + byte_count, byte_count_);
+    // byte-sized clear format so that offset and size need no alignment
+    glClearNamedBufferSubData(handle_, GL_R8UI, offset, byte_count, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+}
+
 } // baldr
@@ -0,0 +1,87 @@
+#include <dirty_regions.hpp>
+
+namespace {
+
+baldr::texture_region
+merged(const baldr::texture_region& a, const baldr::texture_region& b) {
+    baldr::vec3i_t lower = a.offset.cwiseMin(b.offset);
+    baldr::vec3i_t upper = (a.offset + a.extent).cwiseMax(b.offset + b.extent);
+    return {lower, upper - lower};
+}
+
+int64_t
+volume(const baldr::texture_region& r) {
+    return static_cast<int64_t>(r.extent[0]) * r.extent[1] * r.extent[2];
+}
+
+// merge overlapping boxes and adjacent boxes whose bounding box covers no
+// clean texels (i.e. a shared full face); edge or corner contacts stay
+// separate so L-shaped or diagonal updates do not pull in clean areas
+bool
+mergeable(const baldr::texture_region& a, const baldr::texture_region& b) {
+    bool overlap = true;
+    for (int i = 0; i < 3; ++i) {
+        if (a.offset[i] > b.offset[i] + b.extent[i] || b.offset[i] > a.offset[i] + a.extent[i]) {
+            return false;
+        }
+        overlap = overlap && a.offset[i] < b.offset[i] + b.extent[i] && b.offset[i] < a.offset[i] + a.extent[i];
+    }
+    return overlap || volume(merged(a, b)) <= volume(a) + volume(b);
+}
+
+}  // namespace
+
+namespace baldr {
+
+void
+dirty_regions::add(const texture_region& region) {
+    if ((region.extent.array() <= 0).any()) return;
+
+    // merging can make the result touch regions it did not touch before,
+    // so repeat until no more merges happen
+    texture_region current = region;
+    bool merged_any = true;
+    while (merged_any) {
+        merged_any = false;
+        for (auto it = regions_.begin(); it != regions_.end(); ++it) {
+            if (mergeable(current, *it)) {
+                current = merged(current, *it);
+                regions_.erase(it);
+                merged_any = true;
+                break;
+            }
+        }
+    }
+    regions_.push_back(current);
+}
+
+void
+dirty_regions::add(const vec3i_t& offset, const vec3i_t& extent) {
+    add(texture_region{offset, extent});
+}
+
+bool
+dirty_regions::empty() const {
+    return regions_.empty();
+}
+
+void
+dirty_regions::clear() {
+    regions_.clear();
+}
+
+const std::vector<texture_region>&
+dirty_regions::regions() const {
+    return regions_;
+}
+
+size_t
+dirty_regions::texel_count() const {
+    size_t count = 0;
+    for (const auto& region : regions_) {
+        count += region.extent.prod();
+    }
+    return count;
+}
+
+} // baldr
@@ -0,0 +1,73 @@
+#include <fence.hpp>
+
+namespace baldr {
+
+fence::fence() : handle_(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)) {
+}
+
+fence::fence(fence&& other) noexcept : handle_(other.handle_) {
+    other.handle_ = nullptr;
+}
+
+fence::~fence() {
+    if (handle_) {
+        glDeleteSync(handle_);
+    }
+}
+
+fence&
+fence::operator=(fence&& other) noexcept {
+    if (this != &other) {
+        if (handle_) {
+            glDeleteSync(handle_);
+        }
+        handle_ = other.handle_;
+        other.handle_ = nullptr;
+    }
+    return *this;
+}
+
+GLsync
+fence::handle() const {
+    return handle_;
+}
+
+bool
+fence::signaled() const {
+    if (!handle_) {
+        return true;
+    }
+
+    GLint status = GL_UNSIGNALED;
+    glGetSynciv(handle_, GL_SYNC_STATUS, 1, nullptr, &status);
+    return status == GL_SIGNALED;
+}
+
+bool
+fence::wait(GLuint64 timeout) const {
+    if (!handle_) {
+        return true;
+    }
+
+    // flush on the first attempt so that the fence is guaranteed to be
+    // submitted, otherwise waiting without a timeout could deadlock
+    GLenum result = glClientWaitSync(handle_, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+        return true;
+    }
+    if (result == GL_WAIT_FAILED || timeout == 0) {
+        return false;
+    }
+
+    result = glClientWaitSync(handle_, 0, timeout);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void
+fence::wait_server() const {
+    if (handle_) {
+        glWaitSync(handle_, 0, GL_TIMEOUT_IGNORED);
+    }
+}
+
+} // baldr
@@ -0,0 +1,55 @@
+#include <frame_context.hpp>
+
+namespace baldr {
+
+frame_context::frame_context(GLuint frames_in_flight) : frames_in_flight_(frames_in_flight), frame_number_(0), in_frame_(false), fences_(frames_in_flight) {
+    terminate_unless(frames_in_flight > 0, "frame_context requires at least one frame in flight");
+}
+
+frame_context::~frame_context() {
+}
+
+GLuint
+frame_context::frames_in_flight() const {
+    return frames_in_flight_;
+}
+
+GLuint
+frame_context::frame_index() const {
+    return static_cast<GLuint>(frame_number_ % frames_in_flight_);
+}
+
+uint64_t
+frame_context::frame_number() const {
+    return frame_number_;
+}
+
+void
+frame_context::begin_frame() {
+    terminate_unless(!in_frame_, "frame_context::begin_frame() called twice without end_frame()");
+    if (auto& f = fences_[frame_index()]) {
+        f->wait();
+        f.reset();
+    }
+    in_frame_ = true;
+}
+
+void
+frame_context::end_frame() {
+    terminate_unless(in_frame_, "frame_context::end_frame() called without begin_frame()");
+    fences_[frame_index()].emplace();
+    ++frame_number_;
+    in_frame_ = false;
+}
+
+void
+frame_context::wait_idle() {
+    for (auto& f : fences_) {
+        if (f) {
+            f->wait();
+            f.reset();
+        }
+    }
+}
+
+} // baldr
@@ -33,6 +33,21 @@ void
 framebuffer::attach(GLenum attachment, const texture& tex, GLint level)
 {
     glNamedFramebufferTexture(handle_, attachment, tex.handle(), level);
+    track_draw_buffer_(attachment, tex);
+}
+
+void
+framebuffer::attach_layer(GLenum attachment, const texture& tex, GLint layer, GLint level)
+{
+    terminate_unless(tex.layered(), "Layer attachment requires a layered texture");
+    glNamedFramebufferTextureLayer(handle_, attachment, tex.handle(), level, layer);
+    track_draw_buffer_(attachment, tex);
+}
+
+void
+framebuffer::track_draw_buffer_(GLenum attachment, const texture& tex)
+{
+    samples_[attachment] = tex.samples();
     if (attachment != GL_DEPTH_ATTACHMENT && attachment != GL_STENCIL_ATTACHMENT && attachment != GL_DEPTH_STENCIL_ATTACHMENT) {
         attachments_.insert(attachment);
         std::vector<GLenum> buffers(attachments_.begin(), attachments_.end());
@@ -43,6 +58,12 @@ framebuffer::attach(GLenum attachment, const texture& tex, GLint level)
 void
 framebuffer::detach(GLenum attachment)
 {
+    samples_.erase(attachment);
+    if (attachment == GL_DEPTH_ATTACHMENT || attachment == GL_STENCIL_ATTACHMENT || attachment == GL_DEPTH_STENCIL_ATTACHMENT) {
+        glNamedFramebufferTexture(handle_, attachment, 0, 0);
+        return;
+    }
+
     auto it = attachments_.find(attachment);
     if (it == attachments_.end()) {
         fail("Trying to detach texture from framebuffer that was not attached before.");
@@ -61,6 +82,15 @@ framebuffer::check() {
     return !handle_ || GL_FRAMEBUFFER_COMPLETE == glCheckNamedFramebufferStatus(handle_, target_);
 }
 
+GLsizei
+framebuffer::samples() const {
+    GLsizei count = 0;
+    for (const auto& [attachment, attachment_samples] : samples_) {
+        count = std::max(count, attachment_samples);
+    }
+    return count;
+}
+
 void
 framebuffer::clear_color(const vec4f_t& rgba, GLint draw_buffer) {
     float col[4];
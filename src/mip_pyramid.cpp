@@ -0,0 +1,157 @@
+#include <mip_pyramid.hpp>
+
+namespace baldr {
+
+mip_pyramid::mip_pyramid(GLenum internal_format, mip_reduction reduction) : internal_format_(internal_format) {
+    switch (reduction) {
+        case mip_reduction::min: init_("min(a, b)", "v"); break;
+        case mip_reduction::max: init_("max(a, b)", "v"); break;
+        default: init_("a + b", "v / n"); break;
+    }
+}
+
+mip_pyramid::mip_pyramid(GLenum internal_format, const std::string& reduce, const std::string& finish) : internal_format_(internal_format) {
+    init_(reduce, finish);
+}
+
+mip_pyramid::~mip_pyramid() {
+}
+
+void
+mip_pyramid::generate(texture& tex, int base_level) {
+    terminate_unless(tex.specification().internal_format == internal_format_, "Texture format does not match mip pyramid format");
+    int levels = static_cast<int>(tex.specification().levels);
+    for (int level = base_level; level + 1 < levels; ) {
+        level += reduce_(tex, level, tex, level + 1, false);
+    }
+}
+
+void
+mip_pyramid::generate(const texture& source, texture& pyramid) {
+    terminate_unless(pyramid.specification().internal_format == internal_format_, "Texture format does not match mip pyramid format");
+    terminate_unless(source.level_size(0) == pyramid.level_size(0), "Mip pyramid and source texture sizes differ");
+    // the copy dispatch might already have written further levels
+    int written = reduce_(source, 0, pyramid, 0, true);
+    generate(pyramid, written - 1);
+}
+
+void
+mip_pyramid::init_(const std::string& reduce, const std::string& finish) {
+    // the reduction operates on vec4, integer images would need uvec4 variants
+    terminate_unless(!detail::integer_format(internal_format_), "Mip pyramids do not support integer formats");
+    std::string code = fmt::format(R"shader(
+        #version 450
+
+        layout(local_size_x = 8, local_size_y = 8) in;
+
+        uniform sampler2D source;
+        uniform int source_level;
+        uniform int level_count;
+        uniform int copy;
+
+        layout({0}) uniform writeonly image2D target0;
+        layout({0}) uniform writeonly image2D target1;
+        layout({0}) uniform writeonly image2D target2;
+        layout({0}) uniform writeonly image2D target3;
+
+        shared vec4 tile[8][8];
+
+        vec4 reduce(vec4 a, vec4 b) {{
+            return {1};
+        }}
+
+        vec4 finish(vec4 v, float n) {{
+            return {2};
+        }}
+
+        void store(int i, ivec2 p, vec4 v) {{
+            if (i == 0 && all(lessThan(p, imageSize(target0)))) imageStore(target0, p, v);
+            if (i == 1 && all(lessThan(p, imageSize(target1)))) imageStore(target1, p, v);
+            if (i == 2 && all(lessThan(p, imageSize(target2)))) imageStore(target2, p, v);
+            if (i == 3 && all(lessThan(p, imageSize(target3)))) imageStore(target3, p, v);
+        }}
+
+        void main() {{
+            ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+            ivec2 lp = ivec2(gl_LocalInvocationID.xy);
+            ivec2 source_size = textureSize(source, source_level);
+            ivec2 target_size = imageSize(target0);
+
+            vec4 v;
+            if (copy != 0) {{
+                v = texelFetch(source, min(p, source_size - 1), source_level);
+            }} else {{
+                // the last texel of odd sized levels also covers the remaining row/column
+                ivec2 footprint = ivec2(2);
+                if (p.x == target_size.x - 1 && (source_size.x & 1) == 1) footprint.x = 3;
+                if (p.y == target_size.y - 1 && (source_size.y & 1) == 1) footprint.y = 3;
+                ivec2 base = 2 * p;
+                v = texelFetch(source, min(base, source_size - 1), source_level);
+                for (int y = 0; y < footprint.y; ++y) {{
+                    for (int x = 0; x < footprint.x; ++x) {{
+                        if (x == 0 && y == 0) continue;
+                        v = reduce(v, texelFetch(source, min(base + ivec2(x, y), source_size - 1), source_level));
+                    }}
+                }}
+                v = finish(v, float(footprint.x * footprint.y));
+            }}
+            store(0, p, v);
+
+            for (int i = 1; i < level_count; ++i) {{
+                int stride = 1 << i;
+                int half_stride = stride >> 1;
+                barrier();
+                if (lp.x % half_stride == 0 && lp.y % half_stride == 0) {{
+                    tile[lp.y][lp.x] = v;
+                }}
+                memoryBarrierShared();
+                barrier();
+                if (lp.x % stride == 0 && lp.y % stride == 0) {{
+                    vec4 a = reduce(tile[lp.y][lp.x], tile[lp.y][lp.x + half_stride]);
+                    vec4 b = reduce(tile[lp.y + half_stride][lp.x], tile[lp.y + half_stride][lp.x + half_stride]);
+                    v = finish(reduce(a, b), 4.0);
+                    store(i, ivec2(gl_WorkGroupID.xy) * (8 >> i) + lp / stride, v);
+                }}
+            }}
+        }}
+    )shader", detail::image_format_qualifier(internal_format_), reduce, finish);
+
+    shader_ = shader_program::from_code(code, GL_COMPUTE_SHADER);
+    pass_ = std::make_unique<compute_pass>(shader_);
+}
+
+int
+mip_pyramid::reduce_(const texture& source, int source_level, texture& target, int target_level, bool copy) {
+    terminate_unless(!source.layered() && !target.layered(), "Mip pyramids are only supported for 2D textures");
+    int levels = static_cast<int>(target.specification().levels);
+
+    // chain levels in shared memory as long as each one exactly halves the
+    // previous, odd sizes need the wider footprint of a new dispatch
+    int count = 1;
+    while (count < levels_per_dispatch && target_level + count < levels) {
+        vec3i_t size = target.level_size(target_level + count - 1);
+        if (size[0] % 2 || size[1] % 2) break;
+        ++count;
+    }
+
+    shader_->sampler("source") = source;
+    shader_->uniform("source_level") = source_level;
+    shader_->uniform("level_count") = count;
+    shader_->uniform("copy") = copy ? 1 : 0;
+    for (int i = 0; i < levels_per_dispatch; ++i) {
+        // unused units alias the last written level but are never stored to
+        int level = target_level + std::min(i, count - 1);
+        shader_->image(fmt::format("target{}", i)).bind(target, level, GL_WRITE_ONLY);
+    }
+
+    vec3i_t size = target.level_size(target_level);
+    pass_->execute((size[0] + 7) / 8, (size[1] + 7) / 8, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    for (int i = 0; i < levels_per_dispatch; ++i) {
+        shader_->image(fmt::format("target{}", i)).release(target, target_level);
+    }
+    return count;
+}
+
+} // baldr
@@ -0,0 +1,96 @@
+#include <msaa_resolve.hpp>
+
+namespace baldr {
+
+msaa_resolve::msaa_resolve() {
+    read_fbo_ = std::make_shared<framebuffer>(GL_READ_FRAMEBUFFER);
+    draw_fbo_ = std::make_shared<framebuffer>(GL_DRAW_FRAMEBUFFER);
+}
+
+msaa_resolve::~msaa_resolve() {
+}
+
+void
+msaa_resolve::blit(const texture& source, texture& target, GLbitfield mask) {
+    terminate_unless(source.samples() > 1 && !target.samples(), "Blit resolve requires a multisample source and single sample target");
+    terminate_unless(source.width() == target.width() && source.height() == target.height(), "Resolve source and target sizes differ");
+    terminate_unless(mask == GL_COLOR_BUFFER_BIT || mask == GL_DEPTH_BUFFER_BIT, "Blit resolve supports either color or depth");
+
+    GLenum attachment = mask == GL_COLOR_BUFFER_BIT ? GL_COLOR_ATTACHMENT0 : GL_DEPTH_ATTACHMENT;
+    read_fbo_->attach(attachment, source);
+    draw_fbo_->attach(attachment, target);
+    if (mask == GL_COLOR_BUFFER_BIT) {
+        glNamedFramebufferReadBuffer(read_fbo_->handle(), GL_COLOR_ATTACHMENT0);
+    }
+    glBlitNamedFramebuffer(read_fbo_->handle(), draw_fbo_->handle(),
+                           0, 0, source.width(), source.height(),
+                           0, 0, target.width(), target.height(),
+                           mask, GL_NEAREST);
+    // do not keep references to the textures
+    read_fbo_->detach(attachment);
+    draw_fbo_->detach(attachment);
+}
+
+void
+msaa_resolve::resolve(const texture& source, texture& target, resolve_mode mode) {
+    terminate_unless(source.samples() > 1 && !target.samples(), "Resolve requires a multisample source and single sample target");
+    terminate_unless(!source.layered() && !target.layered(), "Compute resolve only supports 2D textures");
+    terminate_unless(source.width() == target.width() && source.height() == target.height(), "Resolve source and target sizes differ");
+
+    auto& [program, pass] = shader_(mode, target.specification().internal_format);
+    program->sampler("source") = source;
+    program->uniform("sample_count") = static_cast<int>(source.samples());
+    program->image("target").bind(target, 0, GL_WRITE_ONLY);
+    pass->execute((target.width() + 7) / 8, (target.height() + 7) / 8, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+    program->image("target").release(target);
+}
+
+msaa_resolve::resolve_shader&
+msaa_resolve::shader_(resolve_mode mode, GLenum internal_format) {
+    auto key = std::make_pair(mode, internal_format);
+    if (auto it = shaders_.find(key); it != shaders_.end()) {
+        return it->second;
+    }
+
+    // integer targets (e.g. object ids) are sampled and stored as uvec4
+    bool integer = detail::integer_format(internal_format);
+    terminate_unless(!integer || mode != resolve_mode::average, "Integer formats cannot be resolved by averaging");
+
+    std::string reduce = "v + s", finish = "v / float(sample_count)";
+    switch (mode) {
+        case resolve_mode::min: reduce = "min(v, s)"; finish = "v"; break;
+        case resolve_mode::max: reduce = "max(v, s)"; finish = "v"; break;
+        case resolve_mode::first_sample: reduce = "v"; finish = "v"; break;
+        default: break;
+    }
+
+    std::string code = fmt::format(R"shader(
+        #version 450
+
+        layout(local_size_x = 8, local_size_y = 8) in;
+
+        uniform {3}sampler2DMS source;
+        uniform int sample_count;
+        layout({0}) uniform writeonly {3}image2D target;
+
+        void main() {{
+            ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+            if (any(greaterThanEqual(p, imageSize(target)))) return;
+
+            {3}vec4 v = texelFetch(source, p, 0);
+            for (int i = 1; i < sample_count; ++i) {{
+                {3}vec4 s = texelFetch(source, p, i);
+                v = {1};
+            }}
+            imageStore(target, p, {2});
+        }}
+    )shader", detail::image_format_qualifier(internal_format), reduce, finish, integer ? "u" : "");
+
+    resolve_shader shader;
+    shader.program = shader_program::from_code(code, GL_COMPUTE_SHADER);
+    shader.pass = std::make_unique<compute_pass>(shader.program);
+    return shaders_.emplace(key, std::move(shader)).first->second;
+}
+
+} // baldr
@@ -0,0 +1,112 @@
+#include <readback.hpp>
+#include <data_buffer.hpp>
+
+namespace {
+
+constexpr GLsizeiptr min_staging_size = 4096;
+constexpr size_t max_pooled_buffers = 8;
+
+struct pooled_buffer
+{
+    std::unique_ptr<baldr::data_buffer> buffer;
+    std::byte* mapping;
+};
+
+std::vector<pooled_buffer>&
+staging_pool() {
+    static std::vector<pooled_buffer> pool;
+    return pool;
+}
+
+GLsizeiptr
+staging_size(GLsizeiptr byte_count) {
+    GLsizeiptr size = min_staging_size;
+    while (size < byte_count) {
+        size *= 2;
+    }
+    return size;
+}
+
+void
+return_to_pool(baldr::data_buffer* buffer, std::byte* mapping) {
+    auto& pool = staging_pool();
+    if (pool.size() >= max_pooled_buffers) {
+        // drop the smallest buffer since large ones are the expensive ones
+        auto smallest = std::min_element(pool.begin(), pool.end(), [](const auto& a, const auto& b) {
+            return a.buffer->byte_count() < b.buffer->byte_count();
+        });
+        if (smallest->buffer->byte_count() >= buffer->byte_count()) {
+            delete buffer;
+            return;
+        }
+        pool.erase(smallest);
+    }
+    pool.push_back({std::unique_ptr<baldr::data_buffer>(buffer), mapping});
+}
+
+}  // namespace
+
+namespace baldr {
+
+namespace detail {
+
+staging_buffer
+acquire_staging_buffer(GLsizeiptr byte_count) {
+    static auto evictor = resource_registry::instance().add_evictor([] (size_t) { staging_pool().clear(); });
+    (void)evictor;
+
+    auto& pool = staging_pool();
+    auto best = pool.end();
+    for (auto it = pool.begin(); it != pool.end(); ++it) {
+        if (it->buffer->byte_count() >= byte_count && (best == pool.end() || it->buffer->byte_count() < best->buffer->byte_count())) {
+            best = it;
+        }
+    }
+
+    data_buffer* buffer = nullptr;
+    std::byte* mapping = nullptr;
+    if (best != pool.end()) {
+        buffer = best->buffer.release();
+        mapping = best->mapping;
+        pool.erase(best);
+    } else {
+        GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        buffer = new data_buffer(staging_size(byte_count), immutable_storage(flags | GL_CLIENT_STORAGE_BIT));
+        mapping = static_cast<std::byte*>(buffer->map(flags));
+        terminate_unless(mapping != nullptr, "Unable to persistently map staging buffer");
+        buffer->tag("staging");
+    }
+
+    return {
+        std::shared_ptr<data_buffer>(buffer, [mapping](data_buffer* b) { return_to_pool(b, mapping); }),
+        mapping
+    };
+}
+
+}  // namespace detail
+
+readback::readback(detail::staging_buffer staging, GLsizeiptr byte_count) : staging_(std::move(staging)), byte_count_(byte_count) {
+}
+
+bool
+readback::ready() const {
+    return fence_.signaled();
+}
+
+bool
+readback::wait(GLuint64 timeout) const {
+    return fence_.wait(timeout);
+}
+
+GLsizeiptr
+readback::byte_count() const {
+    return byte_count_;
+}
+
+std::span<const std::byte>
+readback::data() const {
+    fence_.wait();
+    return std::span<const std::byte>(staging_.mapping, byte_count_);
+}
+
+} // baldr
@@ -0,0 +1,182 @@
+#include <resource_registry.hpp>
+
+namespace baldr {
+
+resource_registry&
+resource_registry::instance() {
+    static resource_registry registry;
+    return registry;
+}
+
+resource_registry::resource_id
+resource_registry::add(resource_category category, size_t bytes) {
+    bool fits = make_room(bytes);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!fits) {
+        ++total_.over_budget;
+    }
+    resource_id id = next_id_++;
+    resources_[id] = {category, bytes, ""};
+    add_bytes_(total_, bytes);
+    add_bytes_(categories_[category], bytes);
+    return id;
+}
+
+void
+resource_registry::resize(resource_id id, size_t bytes) {
+    size_t old_bytes = this->bytes(id);
+    bool fits = bytes <= old_bytes || make_room(bytes - old_bytes);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = resources_.find(id);
+    if (it == resources_.end()) return;
+    if (!fits) {
+        ++total_.over_budget;
+    }
+    auto& res = it->second;
+    for (auto* usage : {&total_, &categories_[res.category]}) {
+        sub_bytes_(*usage, res.bytes);
+        add_bytes_(*usage, bytes);
+    }
+    if (!res.tag.empty()) {
+        sub_bytes_(tags_[res.tag], res.bytes);
+        add_bytes_(tags_[res.tag], bytes);
+    }
+    res.bytes = bytes;
+}
+
+void
+resource_registry::remove(resource_id id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = resources_.find(id);
+    if (it == resources_.end()) return;
+    const auto& res = it->second;
+    sub_bytes_(total_, res.bytes);
+    sub_bytes_(categories_[res.category], res.bytes);
+    if (!res.tag.empty()) {
+        sub_bytes_(tags_[res.tag], res.bytes);
+    }
+    resources_.erase(it);
+}
+
+void
+resource_registry::tag(resource_id id, const std::string& tag) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = resources_.find(id);
+    if (it == resources_.end()) return;
+    auto& res = it->second;
+    if (!res.tag.empty()) {
+        sub_bytes_(tags_[res.tag], res.bytes);
+    }
+    res.tag = tag;
+    if (!tag.empty()) {
+        add_bytes_(tags_[tag], res.bytes);
+    }
+}
+
+size_t
+resource_registry::bytes(resource_id id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = resources_.find(id);
+    return it == resources_.end() ? 0 : it->second.bytes;
+}
+
+resource_usage
+resource_registry::usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_;
+}
+
+resource_usage
+resource_registry::usage(resource_category category) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = categories_.find(category);
+    return it == categories_.end() ? resource_usage{} : it->second;
+}
+
+resource_usage
+resource_registry::usage(const std::string& tag) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tags_.find(tag);
+    return it == tags_.end() ? resource_usage{} : it->second;
+}
+
+std::map<std::string, resource_usage>
+resource_registry::tag_usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tags_;
+}
+
+void
+resource_registry::set_budget(std::optional<size_t> bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budget_ = bytes;
+    }
+    make_room(0);
+}
+
+std::optional<size_t>
+resource_registry::budget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+resource_registry::evictor_id
+resource_registry::add_evictor(evictor func) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evictor_id id = next_evictor_++;
+    evictors_.emplace_back(id, std::move(func));
+    return id;
+}
+
+void
+resource_registry::remove_evictor(evictor_id id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::erase_if(evictors_, [id] (const auto& e) { return e.first == id; });
+}
+
+bool
+resource_registry::make_room(size_t bytes_needed) {
+    std::vector<std::pair<evictor_id, evictor>> evictors;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!budget_ || total_.bytes + bytes_needed <= *budget_) {
+            return true;
+        }
+        evictors = evictors_;
+    }
+
+    // evictors free resources which unregister themselves, so they have to
+    // run without holding the lock
+    for (const auto& [id, func] : evictors) {
+        size_t missing = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!budget_ || total_.bytes + bytes_needed <= *budget_) {
+                return true;
+            }
+            missing = total_.bytes + bytes_needed - *budget_;
+        }
+        func(missing);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !budget_ || total_.bytes + bytes_needed <= *budget_;
+}
+
+void
+resource_registry::add_bytes_(resource_usage& usage, size_t bytes) {
+    usage.bytes += bytes;
+    usage.high_water_mark = std::max(usage.high_water_mark, usage.bytes);
+    ++usage.count;
+}
+
+void
+resource_registry::sub_bytes_(resource_usage& usage, size_t bytes) {
+    usage.bytes -= std::min(usage.bytes, bytes);
+    --usage.count;
+}
+
+} // baldr
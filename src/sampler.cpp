@@ -0,0 +1,113 @@
+#include <sampler.hpp>
+
+#include <unordered_map>
+
+namespace baldr {
+
+namespace {
+
+template <typename T>
+void
+hash_combine(size_t& seed, const T& value) {
+    seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+}  // namespace
+
+size_t
+sampler_state_hash::operator()(const sampler_state& state) const {
+    size_t seed = 0;
+    hash_combine(seed, std::get<0>(state.filter));
+    hash_combine(seed, std::get<1>(state.filter));
+    hash_combine(seed, std::get<0>(state.wrap_mode));
+    hash_combine(seed, std::get<1>(state.wrap_mode));
+    hash_combine(seed, std::get<2>(state.wrap_mode));
+    hash_combine(seed, state.max_anisotropy);
+    hash_combine(seed, state.compare_func);
+    return seed;
+}
+
+sampler::sampler(const sampler_state& state) : state_(state) {
+    glCreateSamplers(1, &handle_);
+    glSamplerParameteri(handle_, GL_TEXTURE_MIN_FILTER, std::get<0>(state.filter));
+    glSamplerParameteri(handle_, GL_TEXTURE_MAG_FILTER, std::get<1>(state.filter));
+    glSamplerParameteri(handle_, GL_TEXTURE_WRAP_S, std::get<0>(state.wrap_mode));
+    glSamplerParameteri(handle_, GL_TEXTURE_WRAP_T, std::get<1>(state.wrap_mode));
+    glSamplerParameteri(handle_, GL_TEXTURE_WRAP_R, std::get<2>(state.wrap_mode));
+    if (state.max_anisotropy > 1.f) {
+        glSamplerParameterf(handle_, GL_TEXTURE_MAX_ANISOTROPY, state.max_anisotropy);
+    }
+    if (state.compare_func != GL_NONE) {
+        glSamplerParameteri(handle_, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glSamplerParameteri(handle_, GL_TEXTURE_COMPARE_FUNC, state.compare_func);
+    }
+}
+
+sampler::~sampler() {
+    glDeleteSamplers(1, &handle_);
+}
+
+std::shared_ptr<sampler>
+sampler::get(const sampler_state& state) {
+    // weak references so that unused samplers get deleted with their last user
+    static std::unordered_map<sampler_state, std::weak_ptr<sampler>, sampler_state_hash> cache;
+
+    auto& entry = cache[state];
+    if (auto cached = entry.lock()) {
+        return cached;
+    }
+    auto created = std::make_shared<sampler>(state);
+    entry = created;
+
+    // drop expired entries once in a while
+    if (cache.size() > 64) {
+        std::erase_if(cache, [] (const auto& item) { return item.second.expired(); });
+    }
+    return created;
+}
+
+std::shared_ptr<sampler>
+sampler::nearest(GLint wrap_mode) {
+    return get({{GL_NEAREST, GL_NEAREST}, {wrap_mode, wrap_mode, wrap_mode}});
+}
+
+std::shared_ptr<sampler>
+sampler::linear(GLint wrap_mode) {
+    return get({{GL_LINEAR, GL_LINEAR}, {wrap_mode, wrap_mode, wrap_mode}});
+}
+
+std::shared_ptr<sampler>
+sampler::trilinear(GLint wrap_mode, float max_anisotropy) {
+    return get({{GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR}, {wrap_mode, wrap_mode, wrap_mode}, max_anisotropy});
+}
+
+void
+sampler::bind(GLuint first_unit, std::span<const std::shared_ptr<sampler>> samplers) {
+    std::vector<GLuint> handles(samplers.size());
+    std::transform(samplers.begin(), samplers.end(), handles.begin(), [] (const auto& s) {
+        return s ? s->handle() : 0;
+    });
+    glBindSamplers(first_unit, handles.size(), handles.data());
+}
+
+void
+sampler::unbind(GLuint unit) {
+    glBindSampler(unit, 0);
+}
+
+GLuint
+sampler::handle() const {
+    return handle_;
+}
+
+const sampler_state&
+sampler::state() const {
+    return state_;
+}
+
+void
+sampler::bind(GLuint unit) const {
+    glBindSampler(unit, handle_);
+}
+
+} // baldr
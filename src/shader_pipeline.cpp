@@ -13,7 +13,30 @@ shader_pipeline::add_stage(std::shared_ptr<shader_program> shader) {
         case GL_TESS_CONTROL_SHADER: stage = GL_TESS_CONTROL_SHADER_BIT; break;
         default: stage = GL_TESS_EVALUATION_SHADER_BIT; break;
     }
+    stages_.erase(stage);
+    check_bindings_(*shader);
     glUseProgramStages(handle_, stage, shader->program());
+    stages_[stage] = std::move(shader);
+}
+
+void
+shader_pipeline::check_bindings_(const shader_program& shader) const {
+    // a block seen by several stages may share its binding point, distinct
+    // blocks may not
+    auto check = [](const auto& blocks, const auto& other_blocks, const char* kind) {
+        for (const auto& [name, block] : blocks) {
+            for (const auto& [other_name, other] : other_blocks) {
+                if (name != other_name && block.binding_point == other.binding_point) {
+                    fail("{} \"{}\" and \"{}\" of different pipeline stages share binding {}",
+                         kind, name, other_name, block.binding_point);
+                }
+            }
+        }
+    };
+    for (const auto& [stage, other] : stages_) {
+        check(shader.uniform_blocks_, other->uniform_blocks_, "Uniform blocks");
+        check(shader.ssbo_, other->ssbo_, "Storage blocks");
+    }
 }
 
 void
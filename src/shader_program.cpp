@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <string_view>
 #include <fstream>
+#include <regex>
 #include <set>
 #include <streambuf>
 
@@ -100,6 +101,93 @@ is_image(GLenum type)
     }
 }
 
+// interface blocks declared with layout(... binding = N ...), as
+// (storage qualifier, block name) pairs
+std::set<std::pair<std::string, std::string>>
+explicit_binding_blocks(const std::string& code)
+{
+    static const std::regex comments(R"(//[^\n]*|/\*[\s\S]*?\*/)");
+    static const std::regex block(R"(layout\s*\(([^)]*)\)\s*(?:\w+\s+)*?(uniform|buffer)\s+(\w+)\s*\{)");
+    static const std::regex binding(R"(\bbinding\s*=)");
+
+    std::string stripped = std::regex_replace(code, comments, " ");
+    std::set<std::pair<std::string, std::string>> blocks;
+    for (std::sregex_iterator it(stripped.begin(), stripped.end(), block), end; it != end; ++it) {
+        const auto& m = *it;
+        if (std::regex_search(m[1].first, m[1].second, binding)) {
+            blocks.emplace(m[2].str(), m[3].str());
+        }
+    }
+    return blocks;
+}
+
+// binding points of blocks without layout(binding = N), shared by every
+// program: a block name always maps to the same point, so stages of a
+// pipeline that declare the same block agree and different blocks never
+// collide. points are handed out from the top of the range to stay clear of
+// the low numbers used by explicit bindings
+class block_bindings
+{
+public:
+    block_bindings(const char* kind, GLenum max_bindings_query)
+        : kind_(kind), max_bindings_query_(max_bindings_query)
+    {}
+
+    GLuint
+    implicit(const std::string& name)
+    {
+        if (auto it = implicit_.find(name); it != implicit_.end()) {
+            return it->second;
+        }
+
+        GLint max_bindings = 0;
+        glGetIntegerv(max_bindings_query_, &max_bindings);
+        GLint binding = max_bindings - 1 - allocated_;
+        while (binding >= 0 && explicit_.contains(static_cast<GLuint>(binding))) {
+            --binding;
+        }
+        if (binding < 0) {
+            baldr::fail("Out of {} binding points for block \"{}\"", kind_, name);
+        }
+        allocated_ = max_bindings - binding;
+        implicit_[name] = static_cast<GLuint>(binding);
+        owners_[static_cast<GLuint>(binding)] = name;
+        return static_cast<GLuint>(binding);
+    }
+
+    void
+    reserve(const std::string& name, GLuint binding)
+    {
+        if (auto it = owners_.find(binding); it != owners_.end() && it->second != name) {
+            baldr::fail("Explicit {} binding {} of block \"{}\" collides with implicitly bound block \"{}\"",
+                        kind_, binding, name, it->second);
+        }
+        explicit_.insert(binding);
+    }
+
+protected:
+    const char* kind_;
+    GLenum max_bindings_query_;
+    GLint allocated_ = 0;
+    std::map<std::string, GLuint> implicit_;
+    std::map<GLuint, std::string> owners_;
+    std::set<GLuint> explicit_;
+};
+
+block_bindings&
+uniform_block_bindings()
+{
+    static block_bindings bindings("uniform block", GL_MAX_UNIFORM_BUFFER_BINDINGS);
+    return bindings;
+}
+
+block_bindings&
+ssbo_bindings()
+{
+    static block_bindings bindings("shader storage", GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS);
+    return bindings;
+}
+
 std::string
 preprocess_shaders(std::string entry_file, std::set<std::string> & already_included, std::vector<std::string> const& include_dirs) {
     std::string accum;
@@ -157,14 +245,30 @@ sampler_unit::operator=(const texture& tex) const
 {
     auto prog = program.lock();
     glBindTextureUnit(unit, tex.handle());
+    sampler::unbind(unit);
     glProgramUniform1i(prog->program(), location, unit);
     return *this;
 }
 
+void
+sampler_unit::bind(const texture& tex, const sampler& smp) const
+{
+    auto prog = program.lock();
+    glBindTextureUnit(unit, tex.handle());
+    smp.bind(unit);
+    glProgramUniform1i(prog->program(), location, unit);
+}
+
 void
 image_unit::bind(const texture& tex, int level, GLenum access) const
 {
-    glBindImageTexture(unit, tex.handle(), level, GL_FALSE, 0, access, tex.specification().internal_format);
+    glBindImageTexture(unit, tex.handle(), level, tex.layered(), 0, access, tex.specification().internal_format);
+}
+
+void
+image_unit::bind_layer(const texture& tex, int layer, int level, GLenum access) const
+{
+    glBindImageTexture(unit, tex.handle(), level, GL_FALSE, layer, access, tex.specification().internal_format);
 }
 
 void
@@ -176,7 +280,7 @@ image_unit::release(const texture& tex, int level) const
 const image_unit&
 image_unit::operator=(const texture& tex) const
 {
-    glBindImageTexture(unit, tex.handle(), 0, GL_FALSE, 0, GL_READ_WRITE, tex.specification().internal_format);
+    bind(tex);
     return *this;
 }
 
@@ -193,6 +297,12 @@ shader_output::bind_image(const texture& tex, int level) const {
     prog->attach_texture_(GL_COLOR_ATTACHMENT0 + location, tex, level);
 }
 
+void
+shader_output::bind_layer(const texture& tex, int layer, int level) const {
+    auto prog = program.lock();
+    prog->attach_texture_(GL_COLOR_ATTACHMENT0 + location, tex, level, layer);
+}
+
 const framebuffer_depth_attachment&
 framebuffer_depth_attachment::operator=(const texture& tex) const {
     auto prog = program.lock();
@@ -206,6 +316,34 @@ shader_ssbo::operator=(const data_buffer& buffer) const {
     return *this;
 }
 
+const shader_ssbo&
+shader_ssbo::operator=(const buffer_allocation& allocation) const {
+    bind(*allocation.buffer, allocation.offset, allocation.byte_count);
+    return *this;
+}
+
+void
+shader_ssbo::bind(const data_buffer& buffer, GLintptr offset, GLsizeiptr byte_count) const {
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding_point, buffer.handle(), offset, byte_count);
+}
+
+const shader_uniform_block&
+shader_uniform_block::operator=(const data_buffer& buffer) const {
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding_point, buffer.handle());
+    return *this;
+}
+
+const shader_uniform_block&
+shader_uniform_block::operator=(const buffer_allocation& allocation) const {
+    bind(*allocation.buffer, allocation.offset, allocation.byte_count);
+    return *this;
+}
+
+void
+shader_uniform_block::bind(const data_buffer& buffer, GLintptr offset, GLsizeiptr byte_count) const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding_point, buffer.handle(), offset, byte_count);
+}
+
 std::shared_ptr<shader_program>
 shader_program::load(const std::string& shader_file,
                      GLuint shader_type,
@@ -257,6 +395,7 @@ shader_program::load_binary(const std::string& shader_file,
         self->query_input_();
         self->query_output_();
         self->query_ssbo_();
+        self->query_uniform_blocks_();
     } else {
         fail("Unable to read shader file \"{}\"", shader_file);
     }
@@ -279,6 +418,7 @@ shader_program::from_code(const std::string& code, GLuint shader_type)
 {
     std::shared_ptr<shader_program> self(new shader_program());
     self->shader_type_ = shader_type;
+    self->explicit_bindings_ = explicit_binding_blocks(code);
 
     self->shader_ = glCreateShader(shader_type);
     const GLchar* source = (const GLchar*)code.c_str();
@@ -322,6 +462,7 @@ shader_program::from_code(const std::string& code, GLuint shader_type)
     self->query_input_();
     self->query_output_();
     self->query_ssbo_();
+    self->query_uniform_blocks_();
 
     return self;
 }
@@ -389,25 +530,32 @@ shader_program::query_uniforms_()
 {
     GLint count = 0;
     glGetProgramInterfaceiv(program_, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
-    std::array<GLenum, 4> properties = {GL_TYPE, GL_ARRAY_SIZE, GL_NAME_LENGTH,
-                                        GL_LOCATION};
+    std::array<GLenum, 5> properties = {GL_TYPE, GL_ARRAY_SIZE, GL_NAME_LENGTH,
+                                        GL_LOCATION, GL_BLOCK_INDEX};
 
     GLuint tex_unit = 0, atomic_counter = 0;
     uniforms_.clear();
     for (GLint idx = 0; idx < count; ++idx) {
-        std::array<GLint, 4> values;
+        std::array<GLint, 5> values;
         glGetProgramResourceiv(program_, GL_UNIFORM, idx, properties.size(),
                                properties.data(), 255, NULL, values.data());
-        auto&& [type, element_count, name_len, loc] = values;
+        auto&& [type, element_count, name_len, loc, block_index] = values;
+        if (block_index >= 0) {
+            // uniform block members are reflected in query_uniform_blocks_()
+            continue;
+        }
         std::string name(name_len - 1, ' ');
         glGetProgramResourceName(program_, GL_UNIFORM, idx, name_len, &name_len,
                                  name.data());
 
         GLuint binding_point = loc;
         if (is_sampler(type)) {
-            samplers_[name] = {tex_unit++,
+            // sampler arrays occupy consecutive units
+            samplers_[name] = {tex_unit,
                                loc,
-                               weak_from_this()};
+                               weak_from_this(),
+                               static_cast<GLuint>(element_count)};
+            tex_unit += element_count;
             continue;
         } else if (is_image(type)) {
             GLint unit = -1;
@@ -433,36 +581,175 @@ shader_program::query_uniforms_()
     }
 }
 
+bool
+shader_program::explicit_binding_(const std::string& storage, const std::string& block) const
+{
+    return !explicit_bindings_ || explicit_bindings_->contains({storage, block});
+}
+
 void
 shader_program::query_ssbo_()
 {
     GLint count = 0;
     glGetProgramInterfaceiv(program_, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &count);
-    std::array<GLenum, 2> properties = {GL_BUFFER_BINDING, GL_NAME_LENGTH};
+    std::array<GLenum, 4> properties = {GL_BUFFER_BINDING, GL_NAME_LENGTH,
+                                        GL_BUFFER_DATA_SIZE, GL_NUM_ACTIVE_VARIABLES};
+    std::array<GLenum, 8> variable_properties = {GL_TYPE, GL_OFFSET, GL_ARRAY_SIZE,
+                                                 GL_ARRAY_STRIDE, GL_MATRIX_STRIDE,
+                                                 GL_TOP_LEVEL_ARRAY_SIZE,
+                                                 GL_TOP_LEVEL_ARRAY_STRIDE,
+                                                 GL_NAME_LENGTH};
+    GLenum active_variables = GL_ACTIVE_VARIABLES;
 
     //GLuint tex_unit = 0, img_unit = 0, atomic_counter = 0;
     //uniforms_.clear();
+    auto& bindings = ssbo_bindings();
+    std::set<GLuint> used_bindings;
     for (GLint idx = 0; idx < count; ++idx) {
-        std::array<GLint, 2> values;
+        std::array<GLint, 4> values;
         glGetProgramResourceiv(program_, GL_SHADER_STORAGE_BLOCK, idx, properties.size(),
                                properties.data(), 255, NULL, values.data());
-        auto&& [binding, name_len] = values;
+        auto&& [binding, name_len, data_size, variable_count] = values;
         std::string name(name_len - 1, ' ');
         glGetProgramResourceName(program_, GL_SHADER_STORAGE_BLOCK, idx, name_len, &name_len,
                                  name.data());
 
-        ssbo_[name] = shader_ssbo{static_cast<GLuint>(binding)};
+        // same binding scheme as for uniform blocks
+        if (explicit_binding_("buffer", name)) {
+            if (!used_bindings.insert(static_cast<GLuint>(binding)).second) {
+                fail("Storage block \"{}\" shares explicit binding {} with another block", name, binding);
+            }
+            bindings.reserve(name, static_cast<GLuint>(binding));
+        } else {
+            binding = static_cast<GLint>(bindings.implicit(name));
+            glShaderStorageBlockBinding(program_, idx, static_cast<GLuint>(binding));
+        }
+
+        shader_ssbo ssbo{static_cast<GLuint>(binding), name, static_cast<GLuint>(data_size), {}};
+
+        std::vector<GLint> variable_indices(variable_count);
+        glGetProgramResourceiv(program_, GL_SHADER_STORAGE_BLOCK, idx, 1, &active_variables,
+                               variable_count, NULL, variable_indices.data());
+        for (GLint variable_idx : variable_indices) {
+            std::array<GLint, 8> variable_values;
+            glGetProgramResourceiv(program_, GL_BUFFER_VARIABLE, variable_idx, variable_properties.size(),
+                                   variable_properties.data(), 255, NULL, variable_values.data());
+            auto&& [type, offset, array_size, array_stride, matrix_stride, top_size, top_stride, variable_name_len] = variable_values;
+            std::string variable_name(variable_name_len - 1, ' ');
+            glGetProgramResourceName(program_, GL_BUFFER_VARIABLE, variable_idx, variable_name_len,
+                                     &variable_name_len, variable_name.data());
+
+            if (variable_name.starts_with(name + ".")) {
+                variable_name = variable_name.substr(name.size() + 1);
+            }
+
+            ssbo.variables[variable_name] = {static_cast<GLenum>(type),
+                                             static_cast<GLuint>(offset),
+                                             static_cast<GLuint>(array_size),
+                                             static_cast<GLuint>(array_stride),
+                                             static_cast<GLuint>(matrix_stride),
+                                             static_cast<GLuint>(top_size),
+                                             static_cast<GLuint>(top_stride)};
+        }
+
+        ssbo_[name] = std::move(ssbo);
+    }
+}
+
+void
+shader_program::query_uniform_blocks_()
+{
+    GLint count = 0;
+    glGetProgramInterfaceiv(program_, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &count);
+    std::array<GLenum, 4> properties = {GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE,
+                                        GL_NAME_LENGTH, GL_NUM_ACTIVE_VARIABLES};
+    std::array<GLenum, 6> member_properties = {GL_TYPE, GL_OFFSET, GL_ARRAY_SIZE,
+                                               GL_ARRAY_STRIDE, GL_MATRIX_STRIDE,
+                                               GL_NAME_LENGTH};
+    GLenum active_variables = GL_ACTIVE_VARIABLES;
+
+    struct block_info
+    {
+        std::string name;
+        GLuint binding;
+        GLint data_size;
+        GLint member_count;
+    };
+    std::vector<block_info> infos;
+    for (GLint idx = 0; idx < count; ++idx) {
+        std::array<GLint, 4> values;
+        glGetProgramResourceiv(program_, GL_UNIFORM_BLOCK, idx, properties.size(),
+                               properties.data(), 255, NULL, values.data());
+        auto&& [binding, data_size, name_len, member_count] = values;
+        std::string name(name_len - 1, ' ');
+        glGetProgramResourceName(program_, GL_UNIFORM_BLOCK, idx, name_len, &name_len,
+                                 name.data());
+        infos.push_back({name, static_cast<GLuint>(binding), data_size, member_count});
+    }
+
+    // explicit bindings must not collide within the program; the others get
+    // the process-wide binding point of their block name
+    auto& bindings = uniform_block_bindings();
+    std::set<GLuint> used_bindings;
+    for (GLint idx = 0; idx < count; ++idx) {
+        auto& info = infos[idx];
+        if (explicit_binding_("uniform", info.name)) {
+            if (!used_bindings.insert(info.binding).second) {
+                fail("Uniform block \"{}\" shares explicit binding {} with another block", info.name, info.binding);
+            }
+            bindings.reserve(info.name, info.binding);
+            continue;
+        }
+        info.binding = bindings.implicit(info.name);
+        glUniformBlockBinding(program_, idx, info.binding);
+    }
+
+    uniform_blocks_.clear();
+    for (GLint idx = 0; idx < count; ++idx) {
+        const auto& [name, binding_point, data_size, member_count] = infos[idx];
+
+        shader_uniform_block block{name, binding_point, static_cast<GLuint>(data_size), {}};
+
+        std::vector<GLint> member_indices(member_count);
+        glGetProgramResourceiv(program_, GL_UNIFORM_BLOCK, idx, 1, &active_variables,
+                               member_count, NULL, member_indices.data());
+        for (GLint member_idx : member_indices) {
+            std::array<GLint, 6> member_values;
+            glGetProgramResourceiv(program_, GL_UNIFORM, member_idx, member_properties.size(),
+                                   member_properties.data(), 255, NULL, member_values.data());
+            auto&& [type, offset, array_size, array_stride, matrix_stride, member_name_len] = member_values;
+            std::string member_name(member_name_len - 1, ' ');
+            glGetProgramResourceName(program_, GL_UNIFORM, member_idx, member_name_len,
+                                     &member_name_len, member_name.data());
+
+            // members are reported as "block.member" for named instances
+            if (member_name.starts_with(name + ".")) {
+                member_name = member_name.substr(name.size() + 1);
+            }
+
+            block.members[member_name] = {static_cast<GLenum>(type),
+                                          static_cast<GLuint>(offset),
+                                          static_cast<GLuint>(array_size),
+                                          static_cast<GLuint>(array_stride),
+                                          static_cast<GLuint>(matrix_stride)};
+        }
+
+        uniform_blocks_[name] = std::move(block);
     }
 }
 
 void
-shader_program::attach_texture_(GLenum attachment, const texture& tex, GLint level) {
+shader_program::attach_texture_(GLenum attachment, const texture& tex, GLint level, GLint layer) {
     if (shader_type_ != GL_FRAGMENT_SHADER) return;
     if (!fbo_->handle()) {
         // still backbuffer bound - create real FBO
         fbo_ = std::make_shared<framebuffer>(GL_FRAMEBUFFER);
     }
-    fbo_->attach(attachment, tex, level);
+    if (layer < 0) {
+        fbo_->attach(attachment, tex, level);
+    } else {
+        fbo_->attach_layer(attachment, tex, layer, level);
+    }
 }
 
 }  // namespace baldr
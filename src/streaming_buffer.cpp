@@ -0,0 +1,107 @@
+#include <streaming_buffer.hpp>
+
+#include <cstring>
+
+namespace {
+
+GLuint
+align_up(GLuint value, GLuint alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+namespace baldr {
+
+streaming_buffer::streaming_buffer(GLuint region_byte_count, GLuint region_count, GLbitfield map_flags)
+    : data_buffer(align_up(region_byte_count, data_buffer::offset_alignment()) * region_count,
+                  immutable_storage(map_flags | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)),
+      region_count_(region_count),
+      region_byte_count_(align_up(region_byte_count, data_buffer::offset_alignment())),
+      alignment_(data_buffer::offset_alignment()),
+      current_(region_count - 1),
+      used_(0),
+      region_{0, 0, 0, nullptr},
+      fences_(region_count)
+{
+    terminate_unless(region_count > 0, "streaming_buffer requires at least one region");
+    mapping_ = static_cast<std::byte*>(glMapNamedBufferRange(handle_, 0, byte_count_, storage_flags_));
+    terminate_unless(mapping_ != nullptr, "Unable to persistently map streaming buffer");
+}
+
+streaming_buffer::~streaming_buffer() {
+    unmap();
+}
+
+GLuint
+streaming_buffer::region_count() const {
+    return region_count_;
+}
+
+GLuint
+streaming_buffer::region_byte_count() const {
+    return region_byte_count_;
+}
+
+GLuint
+streaming_buffer::alignment() const {
+    return alignment_;
+}
+
+streaming_region
+streaming_buffer::acquire() {
+    current_ = (current_ + 1) % region_count_;
+    if (auto& f = fences_[current_]) {
+        f->wait();
+        f.reset();
+    }
+
+    used_ = 0;
+    GLintptr offset = static_cast<GLintptr>(current_) * region_byte_count_;
+    region_ = {current_, offset, region_byte_count_, mapping_ + offset};
+    return region_;
+}
+
+void
+streaming_buffer::release() {
+    fences_[current_].emplace();
+}
+
+void
+streaming_buffer::release(const streaming_region& region) {
+    fences_[region.index].emplace();
+}
+
+GLintptr
+streaming_buffer::allocate(GLsizeiptr byte_count, GLuint alignment) {
+    terminate_unless(region_.data != nullptr, "streaming_buffer::allocate() called before acquire()");
+    GLsizeiptr offset = align_up(static_cast<GLuint>(used_), alignment ? alignment : alignment_);
+    terminate_unless(offset + byte_count <= region_.byte_count, "Streaming buffer region exhausted (requested {} bytes, {} of {} in use)", byte_count, offset, region_.byte_count);
+    used_ = offset + byte_count;
+    return region_.offset + offset;
+}
+
+GLsizeiptr
+streaming_buffer::available(GLuint alignment) const {
+    GLsizeiptr offset = align_up(static_cast<GLuint>(used_), alignment ? alignment : alignment_);
+    return std::max<GLsizeiptr>(region_.byte_count - offset, 0);
+}
+
+GLintptr
+streaming_buffer::write(const void* data, GLsizeiptr byte_count) {
+    GLintptr offset = allocate(byte_count);
+    memcpy(mapping_ + offset, data, byte_count);
+    return offset;
+}
+
+std::byte*
+streaming_buffer::mapped(GLintptr offset) {
+    return mapping_ + offset;
+}
+
+const streaming_region&
+streaming_buffer::current_region() const {
+    return region_;
+}
+
+} // baldr
@@ -1,16 +1,31 @@
 #include <texture.hpp>
+#include <sampler.hpp>
+#include <texture_streamer.hpp>
 
 namespace baldr {
 
-texture::texture(int32_t width, texture_specification specs) : width_(width), height_(0), depth_(0), specs_(specs) {
-    glCreateTextures(GL_TEXTURE_1D, 1, &handle_);
+texture::texture(int32_t width, texture_specification specs) : target_(GL_TEXTURE_1D), width_(width), height_(0), depth_(0), specs_(specs) {
+    terminate_unless(!specs.array, "Array textures require an additional layer dimension");
+    resource_id_ = resource_registry::instance().add(resource_category::texture, storage_bytes());
+    glCreateTextures(target_, 1, &handle_);
     glTextureStorage1D(handle_, specs.levels, specs.internal_format, width);
     set_filter(specs.filter);
     set_wrap_mode(specs.wrap_mode);
 }
 
 texture::texture(int32_t width, int32_t height, texture_specification specs) : width_(width), height_(height), depth_(0), specs_(specs) {
-    glCreateTextures(specs.cubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D, 1, &handle_);
+    terminate_unless(!(specs.array && specs.cubemap), "Cube map arrays require a layer dimension");
+    resource_id_ = resource_registry::instance().add(resource_category::texture, storage_bytes());
+    if (specs.samples > 1) {
+        // multisample textures have neither mip levels nor sampler state
+        terminate_unless(!specs.array && !specs.cubemap && specs.levels == 1, "Multisample textures must be single level 2D textures or 2D arrays");
+        target_ = GL_TEXTURE_2D_MULTISAMPLE;
+        glCreateTextures(target_, 1, &handle_);
+        glTextureStorage2DMultisample(handle_, specs.samples, specs.internal_format, width, height, GL_TRUE);
+        return;
+    }
+    target_ = specs.array ? GL_TEXTURE_1D_ARRAY : (specs.cubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D);
+    glCreateTextures(target_, 1, &handle_);
     glTextureStorage2D(handle_, specs.levels, specs.internal_format, width, height);
     set_filter(specs.filter);
     set_wrap_mode(specs.wrap_mode);
@@ -18,21 +33,209 @@ texture::texture(int32_t width, int32_t height, texture_specification specs) : w
 }
 
 texture::texture(int32_t width, int32_t height, int32_t depth, texture_specification specs) : width_(width), height_(height), depth_(depth), specs_(specs) {
-    glCreateTextures(GL_TEXTURE_3D, 1, &handle_);
-    glTextureStorage3D(handle_, specs.levels, specs.internal_format, width, height, depth);
+    terminate_unless(specs.array || !specs.cubemap, "3D cube maps are only supported as cube map arrays");
+    resource_id_ = resource_registry::instance().add(resource_category::texture, storage_bytes());
+    if (specs.samples > 1) {
+        terminate_unless(specs.array && !specs.cubemap && specs.levels == 1, "Multisample textures must be single level 2D textures or 2D arrays");
+        target_ = GL_TEXTURE_2D_MULTISAMPLE_ARRAY;
+        glCreateTextures(target_, 1, &handle_);
+        glTextureStorage3DMultisample(handle_, specs.samples, specs.internal_format, width, height, depth, GL_TRUE);
+        return;
+    }
+    target_ = specs.array ? (specs.cubemap ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D_ARRAY) : GL_TEXTURE_3D;
+    glCreateTextures(target_, 1, &handle_);
+    glTextureStorage3D(handle_, specs.levels, specs.internal_format, width, height, specs.cubemap ? 6 * depth : depth);
     set_filter(specs.filter);
     set_wrap_mode(specs.wrap_mode);
+    set_max_level(specs.levels-1);
+}
+
+std::shared_ptr<texture>
+texture::array_2d(int32_t width, int32_t height, int32_t layers, texture_specification specs) {
+    specs.array = true;
+    specs.cubemap = false;
+    return std::make_shared<texture>(width, height, layers, specs);
+}
+
+std::shared_ptr<texture>
+texture::cubemap_array(int32_t size, int32_t cubes, texture_specification specs) {
+    specs.array = true;
+    specs.cubemap = true;
+    return std::make_shared<texture>(size, size, cubes, specs);
+}
+
+texture::texture(GLuint handle, GLenum target, int32_t width, int32_t height, int32_t depth, texture_specification specs) : handle_(handle), target_(target), width_(width), height_(height), depth_(depth), specs_(specs) {
+    // views start with default sampling state instead of the parent's
+    if (!specs.samples) {
+        set_filter(specs.filter);
+        set_wrap_mode(specs.wrap_mode);
+        set_max_level(specs.levels - 1);
+    }
+}
+
+std::shared_ptr<texture>
+texture::multisample(int32_t width, int32_t height, GLsizei samples, texture_specification specs) {
+    specs.samples = samples;
+    specs.levels = 1;
+    return std::make_shared<texture>(width, height, specs);
 }
 
 texture::~texture() {
+    if (resource_id_) {
+        resource_registry::instance().remove(resource_id_);
+    }
+    release_residency();
     glDeleteTextures(1, &handle_);
 }
 
+std::shared_ptr<texture>
+texture::view(GLenum internal_format, std::pair<int, int> level_range, std::pair<int, int> layer_range) const {
+    auto [first_level, level_count] = level_range;
+    auto [first_layer, layer_count] = layer_range;
+    int levels = static_cast<int>(specs_.levels);
+    int layers = specs_.array ? this->layer_count() : (specs_.cubemap ? 6 : 1);
+    if (level_count < 0) level_count = levels - first_level;
+    if (layer_count < 0) layer_count = layers - first_layer;
+    terminate_unless(first_level >= 0 && level_count > 0 && first_level + level_count <= levels, "Texture view level range out of bounds");
+    terminate_unless(first_layer >= 0 && layer_count > 0 && first_layer + layer_count <= layers, "Texture view layer range out of bounds");
+
+    vec3i_t size = level_size(first_level);
+    texture_specification specs = specs_;
+    specs.internal_format = internal_format;
+    specs.levels = level_count;
+    if (detail::integer_format(internal_format) != detail::integer_format(specs_.internal_format)) {
+        // switch between e.g. GL_RGBA and GL_RGBA_INTEGER
+        switch (specs_.format) {
+            case GL_RED: specs.format = GL_RED_INTEGER; break;
+            case GL_RG: specs.format = GL_RG_INTEGER; break;
+            case GL_RGB: specs.format = GL_RGB_INTEGER; break;
+            case GL_RGBA: specs.format = GL_RGBA_INTEGER; break;
+            case GL_RED_INTEGER: specs.format = GL_RED; break;
+            case GL_RG_INTEGER: specs.format = GL_RG; break;
+            case GL_RGB_INTEGER: specs.format = GL_RGB; break;
+            case GL_RGBA_INTEGER: specs.format = GL_RGBA; break;
+        }
+    }
+
+    GLenum target = target_;
+    int32_t height = height_ ? size[1] : 0;
+    int32_t depth = depth_ ? size[2] : 0;
+    if (specs_.array || specs_.cubemap) {
+        bool cube = specs_.cubemap && layer_count % 6 == 0;
+        specs.cubemap = cube;
+        specs.array = layer_count > (cube ? 6 : 1);
+        if (target_ == GL_TEXTURE_1D_ARRAY) {
+            target = specs.array ? GL_TEXTURE_1D_ARRAY : GL_TEXTURE_1D;
+            height = specs.array ? layer_count : 0;
+        } else if (cube) {
+            target = specs.array ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_CUBE_MAP;
+            depth = specs.array ? layer_count / 6 : 0;
+        } else if (samples()) {
+            target = specs.array ? GL_TEXTURE_2D_MULTISAMPLE_ARRAY : GL_TEXTURE_2D_MULTISAMPLE;
+            depth = specs.array ? layer_count : 0;
+        } else {
+            target = specs.array ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+            depth = specs.array ? layer_count : 0;
+        }
+    }
+
+    // views need a name without storage, so no glCreateTextures here
+    GLuint handle;
+    glGenTextures(1, &handle);
+    glTextureView(handle, target, handle_, internal_format, first_level, level_count, first_layer, layer_count);
+    return std::shared_ptr<texture>(new texture(handle, target, size[0], height, depth, specs));
+}
+
 GLuint
 texture::handle() const {
     return handle_;
 }
 
+GLenum
+texture::target() const {
+    return target_;
+}
+
+bool
+texture::layered() const noexcept {
+    return depth_ || specs_.cubemap || specs_.array;
+}
+
+int
+texture::layer_count() const noexcept {
+    if (!specs_.array) return 1;
+    return depth_ ? (specs_.cubemap ? 6 * depth_ : depth_) : height_;
+}
+
+GLsizei
+texture::samples() const noexcept {
+    return specs_.samples > 1 ? specs_.samples : 0;
+}
+
+size_t
+texture::storage_bytes() const {
+    size_t bytes = 0;
+    for (GLuint level = 0; level < specs_.levels; ++level) {
+        bytes += compressed() ? compressed_level_bytes(level) : static_cast<size_t>(level_size(level).prod()) * detail::internal_format_bytes(specs_.internal_format);
+    }
+    return bytes * std::max(samples(), 1);
+}
+
+void
+texture::tag(const std::string& tag) {
+    resource_registry::instance().tag(resource_id_, tag);
+}
+
+bool
+texture::bindless_supported() {
+    return GLEW_ARB_bindless_texture;
+}
+
+GLuint64
+texture::bindless_handle(const sampler* smp) {
+    GLuint key = smp ? smp->handle() : 0;
+    auto it = bindless_.find(key);
+    if (it == bindless_.end()) {
+        terminate_unless(bindless_supported(), "Bindless textures are not supported by this context");
+        GLuint64 handle = smp ? glGetTextureSamplerHandleARB(handle_, key) : glGetTextureHandleARB(handle_);
+        it = bindless_.emplace(key, std::make_pair(handle, 0u)).first;
+    }
+    return it->second.first;
+}
+
+void
+texture::make_resident(const sampler* smp) {
+    GLuint64 handle = bindless_handle(smp);
+    auto& count = bindless_[smp ? smp->handle() : 0].second;
+    if (count++ == 0) {
+        glMakeTextureHandleResidentARB(handle);
+    }
+}
+
+void
+texture::make_non_resident(const sampler* smp) {
+    auto it = bindless_.find(smp ? smp->handle() : 0);
+    if (it == bindless_.end() || !it->second.second) return;
+    if (--it->second.second == 0) {
+        glMakeTextureHandleNonResidentARB(it->second.first);
+    }
+}
+
+bool
+texture::has_bindless_handle() const {
+    return !bindless_.empty();
+}
+
+void
+texture::release_residency() {
+    for (auto& [smp, entry] : bindless_) {
+        if (entry.second) {
+            glMakeTextureHandleNonResidentARB(entry.first);
+            entry.second = 0;
+        }
+    }
+}
+
 int
 texture::width() const noexcept {
     return width_;
@@ -56,6 +259,33 @@ texture::pixel_count() const noexcept {
     return count;
 }
 
+vec3i_t
+texture::level_size(int level) const noexcept {
+    // array layers (and cube map faces) are not affected by mip levels
+    bool layer_y = specs_.array && !depth_;
+    bool layer_z = specs_.array || specs_.cubemap;
+    return vec3i_t(
+        std::max(width_ >> level, 1),
+        height_ ? (layer_y ? height_ : std::max(height_ >> level, 1)) : 1,
+        layer_z && !layer_y ? (specs_.array ? layer_count() : 6) : (depth_ ? std::max(depth_ >> level, 1) : 1));
+}
+
+texture_region
+texture::layer_region_(int layer, int level) const {
+    terminate_unless(specs_.array || specs_.cubemap, "Layer access requires an array or cube map texture");
+    vec3i_t size = level_size(level);
+    if (specs_.array && !depth_) {
+        // 1D array: layers along y
+        return {vec3i_t(0, layer, 0), vec3i_t(size[0], 1, 1)};
+    }
+    return {vec3i_t(0, 0, layer), vec3i_t(size[0], size[1], 1)};
+}
+
+texture_region
+texture::level_region(int level) const noexcept {
+    return {vec3i_t::Zero(), level_size(level)};
+}
+
 void
 texture::set_filter(std::tuple<GLint, GLint> filter) {
     glTextureParameteri(handle_, GL_TEXTURE_MIN_FILTER, std::get<0>(filter));
@@ -82,21 +312,8 @@ texture::reset_max_level() {
 template <typename T>
 void
 texture::clear(T value, int level) {
-    terminate_unless(channel_count() != 1, "Scalar clear() function used for texture with more than one channel. Use vector variants instead.");
-    GLuint pixel_type = GL_INT;
-    if constexpr (std::is_same_v<T, float>) {
-        pixel_type = GL_FLOAT;
-    } else if (std::is_same_v<T, uint8_t>) {
-        pixel_type = GL_UNSIGNED_BYTE;
-    } else if (std::is_same_v<T, int8_t>) {
-        pixel_type = GL_BYTE;
-    } else if (std::is_same_v<T, uint16_t>) {
-        pixel_type = GL_UNSIGNED_SHORT;
-    } else if (std::is_same_v<T, int16_t>) {
-        pixel_type = GL_SHORT;
-    } else if (std::is_same_v<T, uint32_t>) {
-        pixel_type = GL_UNSIGNED_INT;
-    }
+    terminate_unless(channel_count() == 1, "Scalar clear() function used for texture with more than one channel. Use vector variants instead.");
+    constexpr GLenum pixel_type = detail::pixel_type<T>();
 
     glClearTexImage(handle_, level, specs_.format, pixel_type, &value);
 }
@@ -106,20 +323,7 @@ void
 texture::set(const T* data) {
     if (!data) return;
 
-    GLuint pixel_type = GL_INT;
-    if constexpr (std::is_same_v<T, float>) {
-        pixel_type = GL_FLOAT;
-    } else if (std::is_same_v<T, uint8_t>) {
-        pixel_type = GL_UNSIGNED_BYTE;
-    } else if (std::is_same_v<T, int8_t>) {
-        pixel_type = GL_BYTE;
-    } else if (std::is_same_v<T, uint16_t>) {
-        pixel_type = GL_UNSIGNED_SHORT;
-    } else if (std::is_same_v<T, int16_t>) {
-        pixel_type = GL_SHORT;
-    } else if (std::is_same_v<T, uint32_t>) {
-        pixel_type = GL_UNSIGNED_INT;
-    }
+    constexpr GLenum pixel_type = detail::pixel_type<T>();
 
     if (depth_) {
         glTextureSubImage3D(handle_, 0, 0, 0, 0, width_, height_, depth_, specs_.format, pixel_type, data);
@@ -135,20 +339,7 @@ void
 texture::set(const T* data, int cubemap_face, int level) {
     if (!data) return;
 
-    GLuint pixel_type = GL_INT;
-    if constexpr (std::is_same_v<T, float>) {
-        pixel_type = GL_FLOAT;
-    } else if (std::is_same_v<T, uint8_t>) {
-        pixel_type = GL_UNSIGNED_BYTE;
-    } else if (std::is_same_v<T, int8_t>) {
-        pixel_type = GL_BYTE;
-    } else if (std::is_same_v<T, uint16_t>) {
-        pixel_type = GL_UNSIGNED_SHORT;
-    } else if (std::is_same_v<T, int16_t>) {
-        pixel_type = GL_SHORT;
-    } else if (std::is_same_v<T, uint32_t>) {
-        pixel_type = GL_UNSIGNED_INT;
-    }
+    constexpr GLenum pixel_type = detail::pixel_type<T>();
 
     glTextureSubImage3D(handle_,
                         level,
@@ -168,20 +359,7 @@ void
 texture::set_cubemap_faces(const T* data, int level) {
     if (!data) return;
 
-    GLuint pixel_type = GL_INT;
-    if constexpr (std::is_same_v<T, float>) {
-        pixel_type = GL_FLOAT;
-    } else if (std::is_same_v<T, uint8_t>) {
-        pixel_type = GL_UNSIGNED_BYTE;
-    } else if (std::is_same_v<T, int8_t>) {
-        pixel_type = GL_BYTE;
-    } else if (std::is_same_v<T, uint16_t>) {
-        pixel_type = GL_UNSIGNED_SHORT;
-    } else if (std::is_same_v<T, int16_t>) {
-        pixel_type = GL_SHORT;
-    } else if (std::is_same_v<T, uint32_t>) {
-        pixel_type = GL_UNSIGNED_INT;
-    }
+    constexpr GLenum pixel_type = detail::pixel_type<T>();
 
     glTextureSubImage3D(handle_,
                         level,
@@ -195,33 +373,155 @@ texture::set_cubemap_faces(const T* data, int level) {
                         pixel_type, data);
 }
 
+void
+texture::set(const data_buffer& pixels, GLintptr offset, GLenum pixel_type, int level) {
+    vec3i_t size = level_size(level);
+    const void* data = reinterpret_cast<const void*>(offset);
+
+    // staged pixels are tightly packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixels.handle());
+    if (depth_ || specs_.cubemap) {
+        glTextureSubImage3D(handle_, level, 0, 0, 0, size[0], size[1], size[2], specs_.format, pixel_type, data);
+    } else if (height_) {
+        glTextureSubImage2D(handle_, level, 0, 0, size[0], size[1], specs_.format, pixel_type, data);
+    } else {
+        glTextureSubImage1D(handle_, level, 0, size[0], specs_.format, pixel_type, data);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void
+texture::set_async_(texture_streamer& streamer, const void* data, int level, GLenum pixel_type, size_t value_size) {
+    if (!data) return;
+
+    vec3i_t size = level_size(level);
+    size_t byte_count = static_cast<size_t>(size.prod()) * channel_count() * value_size;
+    terminate_unless(byte_count <= streamer.slot_byte_count(), "Texture level ({} bytes) exceeds texture streamer slot size ({} bytes)", byte_count, streamer.slot_byte_count());
+
+    streaming_region slot = streamer.reserve();
+    memcpy(slot.data, data, byte_count);
+    streamer.submit(*this, slot, pixel_type, level);
+}
+
+void
+texture::set(const void* data, GLenum pixel_type, const texture_region& region, int level) {
+    if (!data) return;
+    set_region_(data, region, level, pixel_type, 0, 0);
+}
+
+bool
+texture::compressed() const {
+    return detail::compressed_block_bytes(specs_.internal_format) != 0;
+}
+
+GLsizei
+texture::compressed_level_bytes(int level) const {
+    vec3i_t size = level_size(level);
+    GLsizei blocks_x = (size[0] + 3) / 4;
+    GLsizei blocks_y = (size[1] + 3) / 4;
+    return blocks_x * blocks_y * size[2] * detail::compressed_block_bytes(specs_.internal_format);
+}
+
+void
+texture::set_compressed(const void* data, GLsizei byte_count, int level, std::optional<texture_region> region) {
+    if (!data) return;
+    set_compressed_(data, byte_count, level, region ? *region : level_region(level));
+}
+
+void
+texture::set_compressed(const data_buffer& blocks, GLintptr offset, GLsizei byte_count, int level) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, blocks.handle());
+    set_compressed_(reinterpret_cast<const void*>(offset), byte_count, level, level_region(level));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void
+texture::set_compressed_(const void* data, GLsizei byte_count, int level, const texture_region& region) {
+    terminate_unless(compressed(), "Compressed upload to texture with uncompressed internal format");
+    terminate_unless(height_ != 0, "Compressed 1D textures are not supported");
+    const auto& [offset, extent] = region;
+    terminate_unless(offset[0] % 4 == 0 && offset[1] % 4 == 0, "Compressed texture regions must be aligned to 4x4 blocks");
+
+    // the unpack alignment does not apply to compressed blocks, but row lengths
+    // left by region uploads do
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+    if (depth_ || specs_.cubemap || specs_.array) {
+        glCompressedTextureSubImage3D(handle_, level, offset[0], offset[1], offset[2], extent[0], extent[1], extent[2], specs_.internal_format, byte_count, data);
+    } else {
+        glCompressedTextureSubImage2D(handle_, level, offset[0], offset[1], extent[0], extent[1], specs_.internal_format, byte_count, data);
+    }
+}
+
 template <typename T>
 void
 texture::get(GLint level, T* data) {
     if (!data) return;
 
-    GLuint pixel_type = GL_INT;
-    if constexpr (std::is_same_v<T, float>) {
-        pixel_type = GL_FLOAT;
-    } else if (std::is_same_v<T, uint8_t>) {
-        pixel_type = GL_UNSIGNED_BYTE;
-    } else if (std::is_same_v<T, int8_t>) {
-        pixel_type = GL_BYTE;
-    } else if (std::is_same_v<T, uint16_t>) {
-        pixel_type = GL_UNSIGNED_SHORT;
-    } else if (std::is_same_v<T, int16_t>) {
-        pixel_type = GL_SHORT;
-    } else if (std::is_same_v<T, uint32_t>) {
-        pixel_type = GL_UNSIGNED_INT;
+    constexpr GLenum pixel_type = detail::pixel_type<T>();
+
+    vec3i_t size = level_size(level);
+    GLsizei buf_size = channel_count() * size.prod() * sizeof(T);
+    // tightly packed rows so that buf_size is exact
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTextureImage(handle_, level, specs_.format, pixel_type, buf_size, (void*)data);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+}
+
+void
+texture::set_region_(const void* data, const texture_region& region, int level, GLenum pixel_type, int row_length, int image_height) {
+    const auto& [offset, extent] = region;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, image_height);
+    if (depth_ || specs_.cubemap) {
+        glTextureSubImage3D(handle_, level, offset[0], offset[1], offset[2], extent[0], extent[1], extent[2], specs_.format, pixel_type, data);
+    } else if (height_) {
+        glTextureSubImage2D(handle_, level, offset[0], offset[1], extent[0], extent[1], specs_.format, pixel_type, data);
+    } else {
+        glTextureSubImage1D(handle_, level, offset[0], extent[0], specs_.format, pixel_type, data);
     }
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
 
-    GLsizei divisor = std::pow(2, level);
-    int w = width_ / divisor;
-    int h = height_ ? (height_ / divisor) : 1;
-    int d = depth_ ? (depth_ / divisor) : 1;
+void
+texture::get_region_(void* data, size_t byte_count, const texture_region& region, int level, GLenum pixel_type, int row_length, int image_height) {
+    const auto& [offset, extent] = region;
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ROW_LENGTH, row_length);
+    glPixelStorei(GL_PACK_IMAGE_HEIGHT, image_height);
+    glGetTextureSubImage(handle_, level,
+                         offset[0], offset[1], offset[2],
+                         extent[0], extent[1], extent[2],
+                         specs_.format, pixel_type, byte_count, data);
+    glPixelStorei(GL_PACK_IMAGE_HEIGHT, 0);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+}
 
-    GLsizei buf_size = 4 * w * h * d * sizeof(T);
-    glGetTextureImage(handle_, level, specs_.format, pixel_type, buf_size, (void*)data);
+readback
+texture::read_async_(GLint level, const texture_region& region, GLenum pixel_type, size_t value_size) const {
+    const auto& [offset, extent] = region;
+    GLsizei byte_count = static_cast<GLsizei>(extent.prod() * channel_count() * value_size);
+    detail::staging_buffer staging = detail::acquire_staging_buffer(byte_count);
+
+    // tightly packed rows so that the size computed above is exact
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, staging.buffer->handle());
+    glGetTextureSubImage(handle_, level,
+                         offset[0], offset[1], offset[2],
+                         extent[0], extent[1], extent[2],
+                         specs_.format, pixel_type, byte_count, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    return readback(std::move(staging), byte_count);
 }
 
 void
@@ -231,34 +531,7 @@ texture::generate_mipmap() {
 
 uint32_t
 texture::channel_count() const {
-    switch (specs_.format) {
-        case GL_RED:
-            return 1u;
-        case GL_RED_INTEGER:
-            return 1u;
-        case GL_RG:
-            return 2u;
-        case GL_RG_INTEGER:
-            return 2u;
-        case GL_RGB:
-            return 3u;
-        case GL_RGB_INTEGER:
-            return 3u;
-        case GL_BGR:
-            return 3u;
-        case GL_BGR_INTEGER:
-            return 3u;
-        case GL_RGBA:
-            return 4u;
-        case GL_RGBA_INTEGER:
-            return 4u;
-        case GL_BGRA:
-            return 4u;
-        case GL_BGRA_INTEGER:
-            return 4u;
-        default:
-            return 1u;
-    }
+    return detail::channel_count(specs_.format);
 }
 
 const texture_specification&
@@ -266,6 +539,108 @@ texture::specification() const {
     return specs_;
 }
 
+namespace detail {
+
+GLsizei
+compressed_block_bytes(GLenum internal_format) {
+    switch (internal_format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+        case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+        case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+bool
+integer_format(GLenum internal_format) {
+    switch (internal_format) {
+        case GL_R8I: case GL_R8UI: case GL_R16I: case GL_R16UI: case GL_R32I: case GL_R32UI:
+        case GL_RG8I: case GL_RG8UI: case GL_RG16I: case GL_RG16UI: case GL_RG32I: case GL_RG32UI:
+        case GL_RGB8I: case GL_RGB8UI: case GL_RGB16I: case GL_RGB16UI: case GL_RGB32I: case GL_RGB32UI:
+        case GL_RGBA8I: case GL_RGBA8UI: case GL_RGBA16I: case GL_RGBA16UI: case GL_RGBA32I: case GL_RGBA32UI:
+        case GL_RGB10_A2UI:
+            return true;
+        default:
+            return false;
+    }
+}
+
+GLsizei
+internal_format_bytes(GLenum internal_format) {
+    switch (internal_format) {
+        case GL_R8: case GL_R8_SNORM: case GL_R8I: case GL_R8UI:
+        case GL_R3_G3_B2: case GL_RGBA2: case GL_STENCIL_INDEX8:
+            return 1;
+        case GL_RG8: case GL_RG8_SNORM: case GL_RG8I: case GL_RG8UI:
+        case GL_R16: case GL_R16_SNORM: case GL_R16F: case GL_R16I: case GL_R16UI:
+        case GL_RGB4: case GL_RGB5: case GL_RGB565: case GL_RGBA4: case GL_RGB5_A1:
+        case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RGB8: case GL_RGB8_SNORM: case GL_RGB8I: case GL_RGB8UI: case GL_SRGB8:
+        case GL_DEPTH_COMPONENT24:
+            return 3;
+        case GL_RGBA8: case GL_RGBA8_SNORM: case GL_RGBA8I: case GL_RGBA8UI: case GL_SRGB8_ALPHA8:
+        case GL_RG16: case GL_RG16_SNORM: case GL_RG16F: case GL_RG16I: case GL_RG16UI:
+        case GL_R32F: case GL_R32I: case GL_R32UI:
+        case GL_RGB10_A2: case GL_RGB10_A2UI: case GL_R11F_G11F_B10F: case GL_RGB9_E5:
+        case GL_RGB10:
+        case GL_DEPTH_COMPONENT32: case GL_DEPTH_COMPONENT32F: case GL_DEPTH24_STENCIL8:
+            return 4;
+        case GL_RGB12: case GL_RGB16: case GL_RGB16_SNORM: case GL_RGB16F: case GL_RGB16I: case GL_RGB16UI:
+            return 6;
+        case GL_RGBA12: case GL_RGBA16: case GL_RGBA16_SNORM: case GL_RGBA16F: case GL_RGBA16I: case GL_RGBA16UI:
+        case GL_RG32F: case GL_RG32I: case GL_RG32UI:
+        case GL_DEPTH32F_STENCIL8:
+            return 8;
+        case GL_RGB32F: case GL_RGB32I: case GL_RGB32UI:
+            return 12;
+        case GL_RGBA32F: case GL_RGBA32I: case GL_RGBA32UI:
+            return 16;
+        default:
+            break;
+    }
+    fail("No texel size known for internal format {:#x}", internal_format);
+}
+
+const char*
+image_format_qualifier(GLenum internal_format) {
+    switch (internal_format) {
+        case GL_R8: return "r8";
+        case GL_RG8: return "rg8";
+        case GL_RGBA8: return "rgba8";
+        case GL_R16F: return "r16f";
+        case GL_RG16F: return "rg16f";
+        case GL_RGBA16F: return "rgba16f";
+        case GL_R32F: return "r32f";
+        case GL_RG32F: return "rg32f";
+        case GL_RGBA32F: return "rgba32f";
+        case GL_R11F_G11F_B10F: return "r11f_g11f_b10f";
+        case GL_R32UI: return "r32ui";
+        case GL_RGBA8UI: return "rgba8ui";
+        case GL_RGBA32UI: return "rgba32ui";
+        default: break;
+    }
+    fail("No image format qualifier for internal format {:#x}", internal_format);
+}
+
+}  // namespace detail
+
 template void texture::clear<float>(float, int);
 template void texture::clear<uint8_t>(uint8_t, int);
 template void texture::clear<int8_t>(int8_t, int);
@@ -0,0 +1,491 @@
+#include <texture_file.hpp>
+
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <utility>
+
+namespace baldr {
+
+namespace {
+
+struct file_format
+{
+    uint32_t id;
+    GLenum format;
+    GLenum internal_format;
+    GLenum pixel_type;
+    size_t texel_bytes;
+};
+
+// VkFormat values used by KTX2
+constexpr file_format ktx2_formats[] = {
+    {9, GL_RED, GL_R8, GL_UNSIGNED_BYTE, 1},
+    {16, GL_RG, GL_RG8, GL_UNSIGNED_BYTE, 2},
+    {37, GL_RGBA, GL_RGBA8, GL_UNSIGNED_BYTE, 4},
+    {43, GL_RGBA, GL_SRGB8_ALPHA8, GL_UNSIGNED_BYTE, 4},
+    {100, GL_RED, GL_R32F, GL_FLOAT, 4},
+    {109, GL_RGBA, GL_RGBA32F, GL_FLOAT, 16},
+    {131, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 0, 0},
+    {132, GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, 0, 0},
+    {133, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 0, 0},
+    {134, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 0, 0},
+    {135, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 0, 0},
+    {136, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, 0, 0},
+    {137, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 0, 0},
+    {138, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 0, 0},
+    {139, GL_COMPRESSED_RED_RGTC1, GL_COMPRESSED_RED_RGTC1, 0, 0},
+    {140, GL_COMPRESSED_SIGNED_RED_RGTC1, GL_COMPRESSED_SIGNED_RED_RGTC1, 0, 0},
+    {141, GL_COMPRESSED_RG_RGTC2, GL_COMPRESSED_RG_RGTC2, 0, 0},
+    {142, GL_COMPRESSED_SIGNED_RG_RGTC2, GL_COMPRESSED_SIGNED_RG_RGTC2, 0, 0},
+    {143, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 0, 0},
+    {144, GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 0, 0},
+    {145, GL_COMPRESSED_RGBA_BPTC_UNORM, GL_COMPRESSED_RGBA_BPTC_UNORM, 0, 0},
+    {146, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 0, 0}
+};
+
+// DXGI_FORMAT values used by DDS files with DX10 header
+constexpr file_format dxgi_formats[] = {
+    {2, GL_RGBA, GL_RGBA32F, GL_FLOAT, 16},
+    {28, GL_RGBA, GL_RGBA8, GL_UNSIGNED_BYTE, 4},
+    {29, GL_RGBA, GL_SRGB8_ALPHA8, GL_UNSIGNED_BYTE, 4},
+    {41, GL_RED, GL_R32F, GL_FLOAT, 4},
+    {71, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 0, 0},
+    {72, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 0, 0},
+    {74, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 0, 0},
+    {75, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, 0, 0},
+    {77, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 0, 0},
+    {78, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 0, 0},
+    {80, GL_COMPRESSED_RED_RGTC1, GL_COMPRESSED_RED_RGTC1, 0, 0},
+    {81, GL_COMPRESSED_SIGNED_RED_RGTC1, GL_COMPRESSED_SIGNED_RED_RGTC1, 0, 0},
+    {83, GL_COMPRESSED_RG_RGTC2, GL_COMPRESSED_RG_RGTC2, 0, 0},
+    {84, GL_COMPRESSED_SIGNED_RG_RGTC2, GL_COMPRESSED_SIGNED_RG_RGTC2, 0, 0},
+    {95, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 0, 0},
+    {96, GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 0, 0},
+    {98, GL_COMPRESSED_RGBA_BPTC_UNORM, GL_COMPRESSED_RGBA_BPTC_UNORM, 0, 0},
+    {99, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 0, 0}
+};
+
+constexpr uint8_t ktx2_identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+constexpr uint32_t
+four_cc(const char (&code)[5]) {
+    return uint32_t(code[0]) | (uint32_t(code[1]) << 8) | (uint32_t(code[2]) << 16) | (uint32_t(code[3]) << 24);
+}
+
+// files are little endian, as is every platform we run on
+template <typename T>
+T
+read(std::span<const std::byte> data, size_t offset) {
+    terminate_unless(offset + sizeof(T) <= data.size(), "Unexpected end of texture file");
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+// nullptr for unsupported formats
+template <size_t N>
+const file_format*
+find_format(const file_format (&formats)[N], uint32_t id) {
+    auto it = std::find_if(std::begin(formats), std::end(formats), [&] (const file_format& f) { return f.id == id; });
+    return it == std::end(formats) ? nullptr : &*it;
+}
+
+constexpr size_t ktx2_header_bytes = 80;
+constexpr size_t ktx2_level_entry_bytes = 24;
+constexpr size_t dds_header_bytes = 128;
+constexpr size_t dds_dx10_header_bytes = 20;
+// larger counts only occur in corrupt headers
+constexpr uint32_t max_levels = 32;
+constexpr uint32_t max_layers = 2048;
+constexpr uint32_t max_extent = 1 << 16;
+
+}  // namespace
+
+mapped_file::mapped_file(const std::filesystem::path& path) : data_(nullptr), size_(0) {
+#ifdef _MSC_VER
+    file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    mapping_ = nullptr;
+    if (file_ == INVALID_HANDLE_VALUE) {
+        fail("Unable to open file \"{}\"", path.string());
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file_, &size);
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (!size_) return;
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_) {
+        data_ = static_cast<const std::byte*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    fd_ = open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        fail("Unable to open file \"{}\"", path.string());
+    }
+    struct stat info;
+    fstat(fd_, &info);
+    size_ = static_cast<size_t>(info.st_size);
+    if (!size_) return;
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapping != MAP_FAILED) {
+        // levels are read front to back exactly once
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const std::byte*>(mapping);
+    }
+#endif
+    if (!data_) {
+        close_();
+        fail("Unable to map file \"{}\"", path.string());
+    }
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept : data_(other.data_), size_(other.size_) {
+#ifdef _MSC_VER
+    file_ = std::exchange(other.file_, INVALID_HANDLE_VALUE);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+#else
+    fd_ = std::exchange(other.fd_, -1);
+#endif
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+mapped_file::~mapped_file() {
+    close_();
+}
+
+mapped_file&
+mapped_file::operator=(mapped_file&& other) noexcept {
+    if (this != &other) {
+        close_();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+#ifdef _MSC_VER
+        file_ = std::exchange(other.file_, INVALID_HANDLE_VALUE);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+#else
+        fd_ = std::exchange(other.fd_, -1);
+#endif
+    }
+    return *this;
+}
+
+std::span<const std::byte>
+mapped_file::data() const {
+    return std::span<const std::byte>(data_, size_);
+}
+
+size_t
+mapped_file::size() const {
+    return size_;
+}
+
+void
+mapped_file::close_() {
+#ifdef _MSC_VER
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+#else
+    if (data_) munmap(const_cast<std::byte*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+#endif
+    data_ = nullptr;
+}
+
+texture_file::texture_file(const std::filesystem::path& path) : texture_file(mapped_file(path)) {
+    if (!error_.empty()) {
+        fail("{}: \"{}\"", error_, path.string());
+    }
+}
+
+texture_file::texture_file(mapped_file file) : file_(std::move(file)), pixel_type_(0), texel_bytes_(0), extent_(vec3i_t::Zero()), levels_(1), layers_(1), array_(false) {
+    auto data = file_.data();
+    if (data.size() >= sizeof(ktx2_identifier) && std::memcmp(data.data(), ktx2_identifier, sizeof(ktx2_identifier)) == 0) {
+        parse_ktx2_();
+    } else if (data.size() >= 4 && read<uint32_t>(data, 0) == four_cc("DDS ")) {
+        parse_dds_();
+    } else {
+        check_(false, "Unknown texture file format");
+    }
+    specs_.filter = {levels_ > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR, GL_LINEAR};
+}
+
+std::unique_ptr<texture_file>
+texture_file::open(const std::filesystem::path& path, std::string* error) {
+    std::unique_ptr<texture_file> file(new texture_file(mapped_file(path)));
+    if (!file->error_.empty()) {
+        if (error) {
+            *error = fmt::format("{}: \"{}\"", file->error_, path.string());
+        }
+        return nullptr;
+    }
+    return file;
+}
+
+bool
+texture_file::recognized(std::span<const std::byte> data) {
+    if (data.size() >= sizeof(ktx2_identifier) && std::memcmp(data.data(), ktx2_identifier, sizeof(ktx2_identifier)) == 0) {
+        return true;
+    }
+    return data.size() >= 4 && read<uint32_t>(data, 0) == four_cc("DDS ");
+}
+
+std::shared_ptr<texture>
+texture_file::load(const std::filesystem::path& path) {
+    return texture_file(path).create_texture();
+}
+
+const texture_specification&
+texture_file::specification() const {
+    return specs_;
+}
+
+vec3i_t
+texture_file::extent() const {
+    return extent_;
+}
+
+int
+texture_file::level_count() const {
+    return levels_;
+}
+
+std::span<const std::byte>
+texture_file::level_data(int level, int layer) const {
+    auto it = std::find_if(images_.begin(), images_.end(), [&] (const image& img) {
+        return img.level == level && img.layer == layer;
+    });
+    if (it == images_.end()) {
+        return {};
+    }
+    return file_.data().subspan(it->offset, it->byte_count);
+}
+
+std::shared_ptr<texture>
+texture_file::create_texture() const {
+    std::shared_ptr<texture> tex;
+    if (array_ || extent_[2] > 1) {
+        tex = std::make_shared<texture>(extent_[0], extent_[1], extent_[2], specs_);
+    } else {
+        tex = std::make_shared<texture>(extent_[0], extent_[1], specs_);
+    }
+    upload(*tex);
+    return tex;
+}
+
+void
+texture_file::upload(texture& tex) const {
+    int levels = std::min(levels_, static_cast<int>(tex.specification().levels));
+    bool compressed = detail::compressed_block_bytes(specs_.internal_format) != 0;
+    terminate_unless(tex.specification().internal_format == specs_.internal_format, "Texture format does not match texture file");
+
+    for (int level = 0; level < levels; ++level) {
+        // upload whole levels if possible, single layer-faces otherwise
+        if (auto data = level_data(level); !data.empty()) {
+            texture_region region = tex.level_region(level);
+            if (compressed) {
+                tex.set_compressed(data.data(), data.size(), level, region);
+            } else if (pixel_type_ == GL_FLOAT) {
+                tex.set(reinterpret_cast<const float*>(data.data()), region, level);
+            } else {
+                tex.set(reinterpret_cast<const uint8_t*>(data.data()), region, level);
+            }
+            continue;
+        }
+        vec3i_t size = tex.level_size(level);
+        for (int layer = 0; layer < layers_; ++layer) {
+            auto data = level_data(level, layer);
+            terminate_unless(!data.empty(), "Missing image data for level {}, layer {}", level, layer);
+            texture_region region{vec3i_t(0, 0, layer), vec3i_t(size[0], size[1], 1)};
+            if (compressed) {
+                tex.set_compressed(data.data(), data.size(), level, region);
+            } else if (pixel_type_ == GL_FLOAT) {
+                tex.set(reinterpret_cast<const float*>(data.data()), region, level);
+            } else {
+                tex.set(reinterpret_cast<const uint8_t*>(data.data()), region, level);
+            }
+        }
+    }
+}
+
+void
+texture_file::parse_ktx2_() {
+    auto data = file_.data();
+    if (!check_(data.size() >= ktx2_header_bytes, "Truncated KTX2 header")) return;
+    uint32_t vk_format = read<uint32_t>(data, 12);
+    uint32_t width = read<uint32_t>(data, 20);
+    uint32_t height = read<uint32_t>(data, 24);
+    uint32_t depth = read<uint32_t>(data, 28);
+    uint32_t layers = read<uint32_t>(data, 32);
+    uint32_t faces = read<uint32_t>(data, 36);
+    uint32_t levels = read<uint32_t>(data, 40);
+    uint32_t supercompression = read<uint32_t>(data, 44);
+
+    if (!check_(vk_format != 0, "KTX2 files without VkFormat (e.g. Basis Universal) are not supported")
+        || !check_(supercompression == 0, "Supercompressed KTX2 files are not supported")
+        || !check_(width != 0 && height != 0, "1D or empty KTX2 textures are not supported")
+        || !check_(width <= max_extent && height <= max_extent, "Invalid KTX2 image size")
+        || !check_(faces == 1 || faces == 6, fmt::format("Invalid KTX2 face count {}", faces))
+        || !check_(levels <= max_levels, fmt::format("Invalid KTX2 level count {}", levels))
+        || !check_(layers <= max_layers && depth <= max_layers, "Invalid KTX2 layer count or depth")
+        || !check_(data.size() >= ktx2_header_bytes + std::max(levels, 1u) * ktx2_level_entry_bytes, "Truncated KTX2 level index")) {
+        return;
+    }
+
+    const file_format* format = find_format(ktx2_formats, vk_format);
+    if (!check_(format != nullptr, fmt::format("Unsupported KTX2 pixel format {}", vk_format))) return;
+    specs_ = texture_specification{format->format, format->internal_format};
+    pixel_type_ = format->pixel_type;
+    texel_bytes_ = format->texel_bytes;
+    levels_ = std::max(levels, 1u);
+    specs_.levels = levels_;
+    specs_.cubemap = faces == 6;
+    array_ = layers > 0;
+    specs_.array = array_;
+    layers_ = std::max(layers, 1u) * faces;
+    extent_ = vec3i_t(width, height, array_ ? layers : std::max(depth, 1u));
+
+    // level index directly follows the 80 byte header; levels store their
+    // layers and faces contiguously, exactly as glCompressedTextureSubImage3D
+    // expects them
+    for (int level = 0; level < levels_; ++level) {
+        size_t entry = ktx2_header_bytes + level * ktx2_level_entry_bytes;
+        size_t offset = read<uint64_t>(data, entry);
+        size_t byte_count = read<uint64_t>(data, entry + 8);
+        if (!check_(byte_count == image_bytes_(level) * layers_, "Unexpected KTX2 level size")
+            || !add_image_(level, -1, offset, byte_count)) {
+            return;
+        }
+        for (int layer = 0; layer < layers_; ++layer) {
+            add_image_(level, layer, offset + layer * image_bytes_(level), image_bytes_(level));
+        }
+    }
+}
+
+void
+texture_file::parse_dds_() {
+    constexpr uint32_t pixel_format_fourcc = 0x4;
+    constexpr uint32_t caps2_cubemap = 0x200;
+    constexpr uint32_t misc_texture_cube = 0x4;
+    constexpr uint32_t dimension_texture3d = 4;
+
+    auto data = file_.data();
+    if (!check_(data.size() >= dds_header_bytes, "Truncated DDS header")) return;
+    uint32_t height = read<uint32_t>(data, 12);
+    uint32_t width = read<uint32_t>(data, 16);
+    uint32_t depth = read<uint32_t>(data, 24);
+    uint32_t levels = read<uint32_t>(data, 28);
+    uint32_t pf_flags = read<uint32_t>(data, 80);
+    uint32_t fourcc = read<uint32_t>(data, 84);
+    uint32_t caps2 = read<uint32_t>(data, 112);
+
+    if (!check_(pf_flags & pixel_format_fourcc, "Only DDS files with FourCC pixel formats are supported")
+        || !check_(width != 0 && height != 0, "Empty DDS texture")
+        || !check_(width <= max_extent && height <= max_extent && depth <= max_layers, "Invalid DDS image size")
+        || !check_(levels <= max_levels, fmt::format("Invalid DDS level count {}", levels))) {
+        return;
+    }
+
+    size_t offset = 128;
+    uint32_t layers = 1;
+    bool volume = depth > 1;
+    bool cubemap = caps2 & caps2_cubemap;
+    uint32_t format_id = 0;
+    const file_format* format = nullptr;
+    if (fourcc == four_cc("DX10")) {
+        if (!check_(data.size() >= dds_header_bytes + dds_dx10_header_bytes, "Truncated DDS DX10 header")) return;
+        format_id = read<uint32_t>(data, 128);
+        volume = read<uint32_t>(data, 132) == dimension_texture3d;
+        cubemap = read<uint32_t>(data, 136) & misc_texture_cube;
+        layers = std::max(read<uint32_t>(data, 140), 1u);
+        if (!check_(layers <= max_layers, fmt::format("Invalid DDS array size {}", layers))) return;
+        array_ = layers > 1;
+        offset = dds_header_bytes + dds_dx10_header_bytes;
+    } else if (fourcc == four_cc("DXT1")) {
+        format_id = 71;
+    } else if (fourcc == four_cc("DXT3")) {
+        format_id = 74;
+    } else if (fourcc == four_cc("DXT5")) {
+        format_id = 77;
+    } else if (fourcc == four_cc("ATI1") || fourcc == four_cc("BC4U")) {
+        format_id = 80;
+    } else if (fourcc == four_cc("BC4S")) {
+        format_id = 81;
+    } else if (fourcc == four_cc("ATI2") || fourcc == four_cc("BC5U")) {
+        format_id = 83;
+    } else if (fourcc == four_cc("BC5S")) {
+        format_id = 84;
+    } else {
+        check_(false, fmt::format("Unsupported DDS FourCC pixel format {:#x}", fourcc));
+        return;
+    }
+    format = find_format(dxgi_formats, format_id);
+    if (!check_(format != nullptr, fmt::format("Unsupported DDS pixel format {}", format_id))) return;
+
+    specs_ = texture_specification{format->format, format->internal_format};
+    pixel_type_ = format->pixel_type;
+    texel_bytes_ = format->texel_bytes;
+    levels_ = std::max(levels, 1u);
+    specs_.levels = levels_;
+    specs_.cubemap = cubemap;
+    specs_.array = array_;
+    layers_ = layers * (cubemap ? 6 : 1);
+    extent_ = vec3i_t(width, height, array_ ? layers : (volume ? depth : 1));
+
+    // DDS stores the full mip chain of each layer-face one after another
+    for (int layer = 0; layer < layers_; ++layer) {
+        for (int level = 0; level < levels_; ++level) {
+            size_t byte_count = image_bytes_(level);
+            if (!check_(offset + byte_count <= data.size(), "Unexpected end of DDS file")) return;
+            add_image_(level, layer, offset, byte_count);
+            offset += byte_count;
+        }
+    }
+    if (layers_ == 1) {
+        // single images are whole levels as well
+        for (int level = 0; level < levels_; ++level) {
+            auto img = images_[level];
+            add_image_(level, -1, img.offset, img.byte_count);
+        }
+    }
+}
+
+bool
+texture_file::check_(bool condition, const std::string& message) {
+    if (!condition && error_.empty()) {
+        error_ = message;
+    }
+    return condition;
+}
+
+bool
+texture_file::add_image_(int level, int layer, size_t offset, size_t byte_count) {
+    if (!check_(offset <= file_.size() && byte_count <= file_.size() - offset, "Texture file image data out of bounds")) {
+        return false;
+    }
+    images_.push_back({level, layer, offset, byte_count});
+    return true;
+}
+
+size_t
+texture_file::image_bytes_(int level) const {
+    size_t width = std::max(extent_[0] >> level, 1);
+    size_t height = std::max(extent_[1] >> level, 1);
+    // layers are counted separately, only volume slices shrink
+    size_t depth = array_ ? 1 : std::max(extent_[2] >> level, 1);
+    if (GLsizei block_bytes = detail::compressed_block_bytes(specs_.internal_format)) {
+        return ((width + 3) / 4) * ((height + 3) / 4) * depth * block_bytes;
+    }
+    return width * height * depth * texel_bytes_;
+}
+
+} // baldr
@@ -0,0 +1,611 @@
+#include <texture_loader.hpp>
+
+#include <cmath>
+#include <cstring>
+
+namespace baldr {
+
+namespace {
+
+enum load_state : int {
+    loading = 0,
+    loaded,
+    load_failed
+};
+
+// staging buffers are allocated in steps of 64k to improve reuse
+constexpr size_t staging_granularity = size_t(1) << 16;
+
+bool
+has_extension(const std::filesystem::path& path, std::initializer_list<const char*> extensions) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [] (char c) { return static_cast<char>(std::tolower(c)); });
+    return std::find(extensions.begin(), extensions.end(), ext) != extensions.end();
+}
+
+GLenum
+pixel_format(uint32_t channels) {
+    constexpr GLenum formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    return formats[channels - 1];
+}
+
+GLenum
+default_internal_format(const image_header& header, bool srgb) {
+    constexpr GLenum unorm8[] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    constexpr GLenum unorm16[] = {GL_R16, GL_RG16, GL_RGB16, GL_RGBA16};
+    // HDR images are stored as half floats
+    constexpr GLenum half[] = {GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F};
+    uint32_t c = header.channels - 1;
+    switch (header.pixel_type) {
+        case GL_UNSIGNED_BYTE:
+            if (srgb && header.channels == 3) return GL_SRGB8;
+            if (srgb && header.channels == 4) return GL_SRGB8_ALPHA8;
+            return unorm8[c];
+        case GL_UNSIGNED_SHORT:
+            return unorm16[c];
+        default:
+            return half[c];
+    }
+}
+
+GLuint
+full_mip_chain(int32_t width, int32_t height) {
+    return static_cast<GLuint>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
+// reads the next line (without line break) starting at offset
+std::optional<std::string_view>
+read_line(std::span<const std::byte> file, size_t& offset) {
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    size_t end = offset;
+    while (end < file.size() && begin[end] != '\n') {
+        ++end;
+    }
+    if (end >= file.size()) {
+        return std::nullopt;
+    }
+    std::string_view line(begin + offset, end - offset);
+    offset = end + 1;
+    return line;
+}
+
+// parses the radiance header, offset points to the first scanline afterwards
+std::optional<image_header>
+parse_radiance_header(std::span<const std::byte> file, size_t& offset) {
+    offset = 0;
+    auto magic = read_line(file, offset);
+    if (!magic || !magic->starts_with("#?")) {
+        return std::nullopt;
+    }
+    for (;;) {
+        auto line = read_line(file, offset);
+        if (!line) {
+            return std::nullopt;
+        }
+        if (line->empty()) {
+            break;
+        }
+        if (line->starts_with("FORMAT=") && *line != "FORMAT=32-bit_rle_rgbe") {
+            // xyze is not supported
+            return std::nullopt;
+        }
+    }
+    auto resolution = read_line(file, offset);
+    if (!resolution) {
+        return std::nullopt;
+    }
+    // only the common orientations without transposition are supported
+    std::string res(*resolution);
+    int32_t width = 0, height = 0;
+    char y_sign = 0;
+    if (std::sscanf(res.c_str(), "%cY %d +X %d", &y_sign, &height, &width) != 3 || (y_sign != '-' && y_sign != '+') || width <= 0 || height <= 0) {
+        return std::nullopt;
+    }
+    return image_header{width, height, 3, GL_FLOAT};
+}
+
+void
+rgbe_to_float(const uint8_t* rgbe, float* rgb) {
+    if (!rgbe[3]) {
+        rgb[0] = rgb[1] = rgb[2] = 0.f;
+        return;
+    }
+    float f = std::ldexp(1.f, static_cast<int>(rgbe[3]) - (128 + 8));
+    for (int i = 0; i < 3; ++i) {
+        rgb[i] = static_cast<float>(rgbe[i]) * f;
+    }
+}
+
+// skips whitespace and comments, then parses a decimal number
+std::optional<uint32_t>
+read_pnm_number(std::span<const std::byte> file, size_t& offset) {
+    const char* data = reinterpret_cast<const char*>(file.data());
+    while (offset < file.size()) {
+        if (data[offset] == '#') {
+            while (offset < file.size() && data[offset] != '\n') ++offset;
+        } else if (std::isspace(static_cast<unsigned char>(data[offset]))) {
+            ++offset;
+        } else {
+            break;
+        }
+    }
+    uint64_t value = 0;
+    size_t begin = offset;
+    while (offset < file.size() && std::isdigit(static_cast<unsigned char>(data[offset])) && value <= std::numeric_limits<uint32_t>::max()) {
+        value = value * 10 + static_cast<uint64_t>(data[offset++] - '0');
+    }
+    if (offset == begin || value > std::numeric_limits<uint32_t>::max()) {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(value);
+}
+
+struct pnm_header
+{
+    image_header image;
+    uint32_t max_value;
+    size_t data_offset;
+};
+
+std::optional<pnm_header>
+parse_pnm_header(std::span<const std::byte> file) {
+    const char* data = reinterpret_cast<const char*>(file.data());
+    if (file.size() < 2 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) {
+        return std::nullopt;
+    }
+    size_t offset = 2;
+    auto width = read_pnm_number(file, offset);
+    auto height = read_pnm_number(file, offset);
+    auto max_value = read_pnm_number(file, offset);
+    // a single whitespace character separates header and raster
+    if (!width || !height || !max_value || !*width || !*height || !*max_value || *max_value > 65535 || *width > 1u << 16 || *height > 1u << 16 || offset >= file.size()) {
+        return std::nullopt;
+    }
+    pnm_header header;
+    header.image.width = static_cast<int32_t>(*width);
+    header.image.height = static_cast<int32_t>(*height);
+    header.image.channels = data[1] == '5' ? 1 : 3;
+    header.image.pixel_type = *max_value < 256 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+    header.max_value = *max_value;
+    header.data_offset = offset + 1;
+    return header;
+}
+
+}  // namespace
+
+size_t
+image_header::byte_count() const {
+    size_t component_bytes = pixel_type == GL_UNSIGNED_BYTE ? 1 : (pixel_type == GL_UNSIGNED_SHORT ? 2 : 4);
+    return static_cast<size_t>(width) * static_cast<size_t>(height) * channels * component_bytes;
+}
+
+bool
+radiance_hdr_decoder::can_decode(const std::filesystem::path& path, std::span<const std::byte> file) const {
+    return has_extension(path, {".hdr", ".pic"}) || (file.size() >= 2 && std::memcmp(file.data(), "#?", 2) == 0);
+}
+
+std::optional<image_header>
+radiance_hdr_decoder::read_header(std::span<const std::byte> file) const {
+    size_t offset;
+    return parse_radiance_header(file, offset);
+}
+
+bool
+radiance_hdr_decoder::decode(std::span<const std::byte> file, const image_header& header, std::byte* pixels) const {
+    size_t offset;
+    if (!parse_radiance_header(file, offset)) {
+        return false;
+    }
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(file.data());
+    size_t size = file.size();
+    uint32_t width = static_cast<uint32_t>(header.width);
+    std::vector<uint8_t> scanline(width * 4);
+    float* out = reinterpret_cast<float*>(pixels);
+
+    for (int32_t y = 0; y < header.height; ++y) {
+        bool rle = width >= 8 && width < 32768 && offset + 4 <= size
+            && data[offset] == 2 && data[offset + 1] == 2 && ((data[offset + 2] << 8) | data[offset + 3]) == static_cast<int>(width);
+        if (rle) {
+            // new-style rle: each component is run length encoded separately
+            offset += 4;
+            for (uint32_t c = 0; c < 4; ++c) {
+                uint32_t x = 0;
+                while (x < width) {
+                    if (offset >= size) return false;
+                    uint32_t count = data[offset++];
+                    if (count > 128) {
+                        count -= 128;
+                        if (!count || x + count > width || offset >= size) return false;
+                        uint8_t value = data[offset++];
+                        for (uint32_t i = 0; i < count; ++i) scanline[(x++) * 4 + c] = value;
+                    } else {
+                        if (!count || x + count > width || offset + count > size) return false;
+                        for (uint32_t i = 0; i < count; ++i) scanline[(x++) * 4 + c] = data[offset++];
+                    }
+                }
+            }
+        } else {
+            // flat scanline (old-style run length encoding is not supported)
+            if (offset + width * 4 > size) return false;
+            std::memcpy(scanline.data(), data + offset, width * 4);
+            offset += width * 4;
+        }
+
+        for (uint32_t x = 0; x < width; ++x) {
+            rgbe_to_float(&scanline[x * 4], out + (static_cast<size_t>(y) * width + x) * 3);
+        }
+    }
+    return true;
+}
+
+bool
+netpbm_decoder::can_decode(const std::filesystem::path&, std::span<const std::byte> file) const {
+    return parse_pnm_header(file).has_value();
+}
+
+std::optional<image_header>
+netpbm_decoder::read_header(std::span<const std::byte> file) const {
+    if (auto header = parse_pnm_header(file)) {
+        return header->image;
+    }
+    return std::nullopt;
+}
+
+bool
+netpbm_decoder::decode(std::span<const std::byte> file, const image_header& header, std::byte* pixels) const {
+    auto pnm = parse_pnm_header(file);
+    if (!pnm) {
+        return false;
+    }
+    size_t sample_count = header.byte_count() / (header.pixel_type == GL_UNSIGNED_BYTE ? 1 : 2);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(file.data()) + pnm->data_offset;
+    if (pnm->data_offset + header.byte_count() > file.size()) {
+        return false;
+    }
+
+    // samples are rescaled to the full range of the transfer type
+    if (header.pixel_type == GL_UNSIGNED_BYTE) {
+        uint8_t* out = reinterpret_cast<uint8_t*>(pixels);
+        if (pnm->max_value == 255) {
+            std::memcpy(out, data, sample_count);
+        } else {
+            for (size_t i = 0; i < sample_count; ++i) {
+                out[i] = static_cast<uint8_t>(std::min<uint32_t>(data[i], pnm->max_value) * 255 / pnm->max_value);
+            }
+        }
+    } else {
+        // 16 bit samples are stored big endian
+        uint16_t* out = reinterpret_cast<uint16_t*>(pixels);
+        for (size_t i = 0; i < sample_count; ++i) {
+            uint32_t value = std::min<uint32_t>((data[2 * i] << 8) | data[2 * i + 1], pnm->max_value);
+            out[i] = static_cast<uint16_t>(value * 65535 / pnm->max_value);
+        }
+    }
+    return true;
+}
+
+pending_texture::pending_texture(std::filesystem::path path) : path_(std::move(path)), state_(loading) {
+}
+
+const std::filesystem::path&
+pending_texture::path() const {
+    return path_;
+}
+
+bool
+pending_texture::ready() const {
+    return state_.load(std::memory_order_acquire) == loaded;
+}
+
+bool
+pending_texture::failed() const {
+    return state_.load(std::memory_order_acquire) == load_failed;
+}
+
+const std::string&
+pending_texture::error() const {
+    static const std::string none;
+    return failed() ? error_ : none;
+}
+
+std::shared_ptr<texture>
+pending_texture::get() const {
+    return ready() ? texture_ : nullptr;
+}
+
+texture_loader::texture_loader(uint32_t worker_count, size_t max_staging_bytes) : max_staging_bytes_(max_staging_bytes), pending_(0), stop_(false) {
+    decoders_.push_back(std::make_shared<netpbm_decoder>());
+    decoders_.push_back(std::make_shared<radiance_hdr_decoder>());
+    evictor_ = resource_registry::instance().add_evictor([this] (size_t) { trim_staging_(); });
+
+    for (uint32_t i = 0; i < std::max(worker_count, 1u); ++i) {
+        workers_.emplace_back([this] () { work_(); });
+    }
+}
+
+texture_loader::~texture_loader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    resource_registry::instance().remove_evictor(evictor_);
+
+    // unfinished uploads still read from the staging buffers
+    for (auto& slot : staging_) {
+        if (slot->upload) {
+            slot->upload->wait();
+        }
+    }
+}
+
+void
+texture_loader::add_decoder(std::shared_ptr<image_decoder> decoder) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    decoders_.push_back(std::move(decoder));
+}
+
+std::shared_ptr<pending_texture>
+texture_loader::load(const std::filesystem::path& path, const texture_load_options& options) {
+    auto j = std::make_shared<job>();
+    j->next = stage::parse;
+    j->options = options;
+    j->result = std::make_shared<pending_texture>(path);
+
+    ++pending_;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        work_queue_.push_back(j);
+    }
+    work_available_.notify_one();
+    return j->result;
+}
+
+size_t
+texture_loader::update(std::chrono::microseconds budget) {
+    auto start = std::chrono::steady_clock::now();
+    size_t completed = 0;
+
+    // once staging memory runs out, further allocations are deferred (keeping
+    // their order) while uploads continue, since only they release staging
+    std::vector<std::shared_ptr<job>> deferred;
+    do {
+        std::shared_ptr<job> j;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (gl_queue_.empty()) break;
+            j = std::move(gl_queue_.front());
+            gl_queue_.pop_front();
+        }
+
+        bool allocation = j->error.empty() && j->next == stage::allocate;
+        if (allocation && !deferred.empty()) {
+            deferred.push_back(std::move(j));
+            continue;
+        }
+        if (!process_(j)) {
+            deferred.push_back(std::move(j));
+            continue;
+        }
+        if (j->result->state_.load(std::memory_order_relaxed) != loading) {
+            ++completed;
+        }
+    } while (std::chrono::steady_clock::now() - start < budget);
+
+    if (!deferred.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        gl_queue_.insert(gl_queue_.begin(), std::make_move_iterator(deferred.begin()), std::make_move_iterator(deferred.end()));
+    }
+    return completed;
+}
+
+size_t
+texture_loader::pending() const {
+    return pending_.load();
+}
+
+void
+texture_loader::work_() {
+    for (;;) {
+        std::shared_ptr<job> j;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] () { return stop_ || !work_queue_.empty(); });
+            if (stop_) return;
+            j = std::move(work_queue_.front());
+            work_queue_.pop_front();
+        }
+
+        if (j->next == stage::parse) {
+            parse_(*j);
+        } else {
+            if (!j->decoder->decode(j->file->data(), j->header, j->slot->mapping)) {
+                j->error = fmt::format("Unable to decode image file \"{}\"", j->result->path().string());
+            }
+            j->file.reset();
+            j->next = stage::upload;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        gl_queue_.push_back(std::move(j));
+    }
+}
+
+void
+texture_loader::parse_(job& j) {
+    const auto& path = j.result->path();
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec) || !std::filesystem::file_size(path, ec) || ec) {
+        j.error = fmt::format("Unable to open image file \"{}\"", path.string());
+        return;
+    }
+
+    j.file.emplace(path);
+    auto data = j.file->data();
+    if (texture_file::recognized(data)) {
+        j.file.reset();
+        // malformed containers fail this load only
+        j.container = texture_file::open(path, &j.error);
+        j.next = stage::container;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = decoders_.rbegin(); it != decoders_.rend(); ++it) {
+            if ((*it)->can_decode(path, data)) {
+                j.decoder = *it;
+                break;
+            }
+        }
+    }
+    if (!j.decoder) {
+        j.error = fmt::format("No decoder for image file \"{}\"", path.string());
+        return;
+    }
+
+    auto header = j.decoder->read_header(data);
+    if (!header || header->width <= 0 || header->height <= 0 || header->channels < 1 || header->channels > 4) {
+        j.error = fmt::format("Invalid image header in \"{}\"", path.string());
+        return;
+    }
+    j.header = *header;
+    j.next = stage::allocate;
+}
+
+bool
+texture_loader::process_(const std::shared_ptr<job>& j) {
+    if (!j->error.empty()) {
+        finish_(*j);
+        return true;
+    }
+
+    switch (j->next) {
+        case stage::allocate: {
+            j->slot = acquire_staging_(j->header.byte_count());
+            if (!j->slot) return false;
+
+            const auto& options = j->options;
+            texture_specification specs;
+            specs.format = pixel_format(j->header.channels);
+            specs.internal_format = options.internal_format.value_or(default_internal_format(j->header, options.srgb));
+            specs.levels = options.mipmaps ? full_mip_chain(j->header.width, j->header.height) : 1;
+            specs.filter = {options.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR, GL_LINEAR};
+            specs.wrap_mode = options.wrap_mode;
+            j->tex = std::make_shared<texture>(j->header.width, j->header.height, specs);
+            j->tex->tag(j->result->path().filename().string());
+
+            j->next = stage::decode;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                work_queue_.push_back(j);
+            }
+            work_available_.notify_one();
+            return true;
+        }
+
+        case stage::upload: {
+            j->tex->set(*j->slot->buffer, 0, j->header.pixel_type, 0);
+            if (j->options.mipmaps) {
+                j->tex->generate_mipmap();
+            }
+            finish_(*j);
+            return true;
+        }
+
+        case stage::container: {
+            j->tex = j->container->create_texture();
+            j->tex->set_wrap_mode(j->options.wrap_mode);
+            j->tex->tag(j->result->path().filename().string());
+            j->container.reset();
+            finish_(*j);
+            return true;
+        }
+
+        default:
+            fail("Texture load job in unexpected stage");
+    }
+    return true;
+}
+
+texture_loader::staging*
+texture_loader::acquire_staging_(size_t byte_count) {
+    staging* best = nullptr;
+    size_t total = 0;
+    for (auto& slot : staging_) {
+        total += slot->buffer->byte_count();
+        if (slot->in_use) continue;
+        if (slot->upload) {
+            if (!slot->upload->signaled()) continue;
+            slot->upload.reset();
+        }
+        if (slot->buffer->byte_count() >= byte_count && (!best || slot->buffer->byte_count() < best->buffer->byte_count())) {
+            best = slot.get();
+        }
+    }
+    if (best) {
+        best->in_use = true;
+        return best;
+    }
+
+    size_t size = (byte_count + staging_granularity - 1) / staging_granularity * staging_granularity;
+    if (total + size > max_staging_bytes_) {
+        // idle buffers are too small, make room for a bigger one
+        trim_staging_();
+        total = 0;
+        for (auto& slot : staging_) {
+            total += slot->buffer->byte_count();
+        }
+        // oversized images are loaded once everything else is done
+        if (!staging_.empty() && total + size > max_staging_bytes_) {
+            return nullptr;
+        }
+    }
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    auto slot = std::make_unique<staging>();
+    slot->buffer = std::make_unique<data_buffer>(static_cast<GLuint>(size), immutable_storage(flags));
+    slot->mapping = static_cast<std::byte*>(slot->buffer->map(flags));
+    terminate_unless(slot->mapping != nullptr, "Unable to persistently map texture loader staging buffer");
+    slot->buffer->tag("staging");
+    slot->in_use = true;
+    staging_.push_back(std::move(slot));
+    return staging_.back().get();
+}
+
+void
+texture_loader::trim_staging_() {
+    std::erase_if(staging_, [] (const auto& slot) {
+        return !slot->in_use && (!slot->upload || slot->upload->signaled());
+    });
+}
+
+void
+texture_loader::finish_(job& j) {
+    if (j.slot) {
+        // the staging buffer is reused once the upload has been consumed
+        if (j.error.empty()) {
+            j.slot->upload.emplace();
+        }
+        j.slot->in_use = false;
+        j.slot = nullptr;
+    }
+
+    auto& result = *j.result;
+    if (j.error.empty()) {
+        result.texture_ = std::move(j.tex);
+        result.state_.store(loaded, std::memory_order_release);
+    } else {
+        result.error_ = std::move(j.error);
+        result.state_.store(load_failed, std::memory_order_release);
+    }
+    j.tex.reset();
+    j.file.reset();
+    --pending_;
+}
+
+} // baldr
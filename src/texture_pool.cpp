@@ -0,0 +1,116 @@
+#include <texture_pool.hpp>
+
+namespace baldr {
+
+bool
+texture_pool::key::operator<(const key& other) const {
+    auto lhs = std::tie(size[0], size[1], size[2]);
+    auto rhs = std::tie(other.size[0], other.size[1], other.size[2]);
+    if (lhs != rhs) {
+        return lhs < rhs;
+    }
+    return specs < other.specs;
+}
+
+texture_pool::texture_pool(uint32_t max_idle_frames) : state_(std::make_shared<state>()) {
+    state_->max_idle_frames = max_idle_frames;
+    // idle textures are the first to go when running over the memory budget
+    evictor_ = resource_registry::instance().add_evictor([this] (size_t) { trim(); });
+}
+
+texture_pool::~texture_pool() {
+    resource_registry::instance().remove_evictor(evictor_);
+}
+
+std::shared_ptr<texture>
+texture_pool::acquire(int32_t width, const texture_specification& specs) {
+    return acquire_(vec3i_t(width, 0, 0), specs);
+}
+
+std::shared_ptr<texture>
+texture_pool::acquire(int32_t width, int32_t height, const texture_specification& specs) {
+    return acquire_(vec3i_t(width, height, 0), specs);
+}
+
+std::shared_ptr<texture>
+texture_pool::acquire(int32_t width, int32_t height, int32_t depth, const texture_specification& specs) {
+    return acquire_(vec3i_t(width, height, depth), specs);
+}
+
+void
+texture_pool::next_frame() {
+    ++state_->frame;
+    auto& pooled = state_->pooled;
+    for (auto it = pooled.begin(); it != pooled.end(); ) {
+        if (state_->frame - it->second.last_used > state_->max_idle_frames) {
+            it = pooled.erase(it);
+            ++state_->stats.evictions;
+        } else {
+            ++it;
+        }
+    }
+    state_->stats.pooled = pooled.size();
+}
+
+size_t
+texture_pool::trim() {
+    size_t count = state_->pooled.size();
+    state_->pooled.clear();
+    state_->stats.evictions += count;
+    state_->stats.pooled = 0;
+    return count;
+}
+
+texture_pool_statistics
+texture_pool::statistics() const {
+    return state_->stats;
+}
+
+std::shared_ptr<texture>
+texture_pool::acquire_(const vec3i_t& size, const texture_specification& specs) {
+    key k{size, specs};
+    std::unique_ptr<texture> tex;
+
+    auto& pooled = state_->pooled;
+    if (auto it = pooled.find(k); it != pooled.end()) {
+        tex = std::move(it->second.tex);
+        pooled.erase(it);
+        // undo state changes of the previous user; multisample textures
+        // have no sampling state and bindless handles freeze it
+        if (specs.samples <= 1 && !tex->has_bindless_handle()) {
+            tex->set_filter(specs.filter);
+            tex->set_wrap_mode(specs.wrap_mode);
+            tex->reset_max_level();
+        }
+        ++state_->stats.hits;
+    } else {
+        if (size[2]) {
+            tex = std::make_unique<texture>(size[0], size[1], size[2], specs);
+        } else if (size[1]) {
+            tex = std::make_unique<texture>(size[0], size[1], specs);
+        } else {
+            tex = std::make_unique<texture>(size[0], specs);
+        }
+        ++state_->stats.misses;
+    }
+
+    ++state_->stats.leased;
+    state_->stats.pooled = pooled.size();
+
+    std::weak_ptr<state> weak_state = state_;
+    return std::shared_ptr<texture>(tex.release(), [weak_state, k](texture* t) {
+        auto s = weak_state.lock();
+        if (!s) {
+            // pool is gone
+            delete t;
+            return;
+        }
+        --s->stats.leased;
+        // idle textures must not keep their handles resident
+        t->release_residency();
+        s->pooled.emplace(k, entry{std::unique_ptr<texture>(t), s->frame});
+        s->stats.pooled = s->pooled.size();
+    });
+}
+
+} // baldr
@@ -0,0 +1,42 @@
+#include <texture_streamer.hpp>
+
+namespace baldr {
+
+texture_streamer::texture_streamer(GLuint slot_byte_count, GLuint slot_count) : ring_(slot_byte_count, slot_count), reserved_(slot_count, false) {
+}
+
+texture_streamer::~texture_streamer() {
+}
+
+GLuint
+texture_streamer::slot_byte_count() const {
+    return ring_.region_byte_count();
+}
+
+GLuint
+texture_streamer::slot_count() const {
+    return ring_.region_count();
+}
+
+streaming_region
+texture_streamer::reserve() {
+    streaming_region slot = ring_.acquire();
+    terminate_unless(!reserved_[slot.index], "All {} texture streamer slots are reserved but not submitted", ring_.region_count());
+    reserved_[slot.index] = true;
+    return slot;
+}
+
+void
+texture_streamer::submit(texture& tex, const streaming_region& slot, GLenum pixel_type, int level) {
+    terminate_unless(reserved_[slot.index], "Submitting texture streamer slot that has not been reserved");
+    tex.set(ring_, slot.offset, pixel_type, level);
+    ring_.release(slot);
+    reserved_[slot.index] = false;
+}
+
+void
+texture_streamer::cancel(const streaming_region& slot) {
+    reserved_[slot.index] = false;
+}
+
+} // baldr
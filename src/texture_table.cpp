@@ -0,0 +1,117 @@
+#include <texture_table.hpp>
+
+namespace baldr {
+
+texture_table::texture_table(uint32_t capacity, bool force_units) : bindless_(!force_units && texture::bindless_supported()), capacity_(capacity), dirty_(false) {
+    if (bindless_) {
+        handle_buffer_ = std::make_unique<data_buffer>(capacity * sizeof(GLuint64), immutable_storage(GL_DYNAMIC_STORAGE_BIT));
+        handle_buffer_->tag("texture_table");
+    } else {
+        GLint max_units = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_units);
+        terminate_unless(capacity <= static_cast<uint32_t>(max_units), "Texture table capacity {} exceeds the {} texture units available without bindless textures", capacity, max_units);
+    }
+}
+
+texture_table::~texture_table() {
+    clear();
+}
+
+bool
+texture_table::bindless() const {
+    return bindless_;
+}
+
+uint32_t
+texture_table::capacity() const {
+    return capacity_;
+}
+
+uint32_t
+texture_table::size() const {
+    return static_cast<uint32_t>(entries_.size());
+}
+
+uint32_t
+texture_table::add(std::shared_ptr<texture> tex, std::shared_ptr<sampler> smp) {
+    terminate_unless(entries_.size() < capacity_, "Texture table is full ({} entries)", capacity_);
+    entries_.push_back({});
+    handles_.push_back(0);
+    uint32_t index = size() - 1;
+    set(index, std::move(tex), std::move(smp));
+    return index;
+}
+
+void
+texture_table::set(uint32_t index, std::shared_ptr<texture> tex, std::shared_ptr<sampler> smp) {
+    terminate_unless(index < entries_.size(), "Texture table index {} out of range", index);
+    terminate_unless(tex != nullptr, "Texture table entry {} set to a null texture", index);
+    release_(entries_[index]);
+    entries_[index] = {std::move(tex), std::move(smp)};
+    if (bindless_) {
+        auto& e = entries_[index];
+        e.tex->make_resident(e.smp.get());
+        handles_[index] = e.tex->bindless_handle(e.smp.get());
+        dirty_ = true;
+    }
+}
+
+void
+texture_table::clear() {
+    for (auto& e : entries_) {
+        release_(e);
+    }
+    entries_.clear();
+    handles_.clear();
+}
+
+std::string
+texture_table::glsl_declaration(const std::string& name, const std::string& sampler_type) const {
+    if (bindless_) {
+        return fmt::format(
+            "#extension GL_ARB_bindless_texture : require\n"
+            "layout(std430) readonly buffer {0}_handles {{ uvec2 {0}_handle[]; }};\n"
+            "#define {0}(index) {1}({0}_handle[index])\n",
+            name, sampler_type);
+    }
+    return fmt::format(
+        "uniform {1} {0}_units[{2}];\n"
+        "#define {0}(index) {0}_units[index]\n",
+        name, sampler_type, capacity_);
+}
+
+void
+texture_table::bind(const shader_program& program, const std::string& name) {
+    if (bindless_) {
+        if (dirty_ && !handles_.empty()) {
+            handle_buffer_->set_data(handles_.data(), 0, handles_.size() * sizeof(GLuint64));
+            dirty_ = false;
+        }
+        program.ssbo(name + "_handles") = *handle_buffer_;
+        return;
+    }
+
+    const auto& units = program.sampler(name + "_units[0]");
+    uint32_t count = std::min(size(), units.array_size);
+    std::vector<GLuint> textures(count), samplers(count);
+    std::vector<GLint> indices(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        terminate_unless(entries_[i].tex != nullptr, "Texture table entry {} has no texture", i);
+        textures[i] = entries_[i].tex->handle();
+        samplers[i] = entries_[i].smp ? entries_[i].smp->handle() : 0;
+        indices[i] = units.unit + i;
+    }
+    glBindTextures(units.unit, count, textures.data());
+    glBindSamplers(units.unit, count, samplers.data());
+    glProgramUniform1iv(program.program(), units.location, count, indices.data());
+}
+
+void
+texture_table::release_(entry& e) {
+    if (bindless_ && e.tex) {
+        e.tex->make_non_resident(e.smp.get());
+    }
+    e = {};
+}
+
+} // baldr
@@ -0,0 +1,138 @@
+#include <upload_batch.hpp>
+
+#include <cstring>
+
+namespace baldr {
+
+upload_batch::upload_batch(GLuint staging_byte_count, GLuint region_count) : staging_(staging_byte_count, region_count), acquired_(false) {
+}
+
+upload_batch::~upload_batch() {
+    flush();
+}
+
+void
+upload_batch::set_data(data_buffer& buffer, const void* data, GLintptr offset, GLsizeiptr byte_count) {
+    if (!data || !byte_count) return;
+
+    terminate_unless(offset >= 0 && offset + byte_count <= buffer.byte_count(), "Batched upload range [{}, {}) exceeds buffer size {}", offset, offset + byte_count, buffer.byte_count());
+    ++current_.requested_calls;
+    current_.bytes += byte_count;
+
+    // 4 byte alignment keeps consecutive writes contiguous in staging memory
+    GLintptr src_offset = stage_(data, byte_count, 4);
+    if (src_offset < 0) {
+        // larger than a whole staging region, keep ordering with pending writes
+        issue_();
+        ++current_.issued_calls;
+        buffer.set_data(data, offset, byte_count);
+        return;
+    }
+
+    if (!pending_.empty()) {
+        if (auto* last = std::get_if<buffer_copy>(&pending_.back())) {
+            if (last->buffer == &buffer && last->src_offset + last->byte_count == src_offset && last->dst_offset + last->byte_count == offset) {
+                last->byte_count += byte_count;
+                return;
+            }
+        }
+    }
+
+    pending_.push_back(buffer_copy{&buffer, src_offset, offset, byte_count});
+}
+
+void
+upload_batch::flush() {
+    issue_();
+
+    if (!current_.requested_calls) {
+        return;
+    }
+
+    last_ = current_;
+    total_.bytes += current_.bytes;
+    total_.requested_calls += current_.requested_calls;
+    total_.issued_calls += current_.issued_calls;
+    current_ = upload_statistics();
+}
+
+bool
+upload_batch::empty() const {
+    return pending_.empty();
+}
+
+const upload_statistics&
+upload_batch::last_statistics() const {
+    return last_;
+}
+
+const upload_statistics&
+upload_batch::total_statistics() const {
+    return total_;
+}
+
+void
+upload_batch::issue_() {
+    if (pending_.empty()) {
+        return;
+    }
+
+    for (const auto& op : pending_) {
+        std::visit(overloaded {
+            [&](const buffer_copy& copy) {
+                glCopyNamedBufferSubData(staging_.handle(), copy.buffer->handle(), copy.src_offset, copy.dst_offset, copy.byte_count);
+            },
+            [&](const texture_upload& upload) {
+                upload.tex->set(staging_, upload.src_offset, upload.pixel_type, upload.level);
+            }
+        }, op);
+        ++current_.issued_calls;
+    }
+    pending_.clear();
+
+    staging_.release();
+    acquired_ = false;
+}
+
+void
+upload_batch::set_(texture& tex, const void* data, GLsizeiptr byte_count, GLuint value_size, GLenum pixel_type, int level) {
+    if (!data || !byte_count) return;
+
+    ++current_.requested_calls;
+    current_.bytes += byte_count;
+
+    GLintptr src_offset = stage_(data, byte_count, value_size);
+    if (src_offset < 0) {
+        // larger than a whole staging region, keep ordering with pending writes
+        issue_();
+        ++current_.issued_calls;
+        data_buffer pixels(byte_count, immutable_storage(0), data);
+        tex.set(pixels, 0, pixel_type, level);
+        return;
+    }
+
+    pending_.push_back(texture_upload{&tex, src_offset, pixel_type, level});
+}
+
+GLintptr
+upload_batch::stage_(const void* data, GLsizeiptr byte_count, GLuint alignment) {
+    if (byte_count > static_cast<GLsizeiptr>(staging_.region_byte_count())) {
+        return -1;
+    }
+
+    if (acquired_ && staging_.available(alignment) < byte_count) {
+        // region exhausted, issue what we have so far and continue in the next one
+        issue_();
+    }
+
+    if (!acquired_) {
+        staging_.acquire();
+        acquired_ = true;
+    }
+
+    GLintptr offset = staging_.allocate(byte_count, alignment);
+    memcpy(staging_.mapped(offset), data, byte_count);
+    return offset;
+}
+
+} // baldr
@@ -8,7 +8,18 @@ binding_point::operator=(const data_buffer& buffer) const {
     return *this;
 }
 
-vertex_array::vertex_array() : handle_(0), next_binding_point_(0) {
+const binding_point&
+binding_point::operator=(const buffer_allocation& allocation) const {
+    bind(*allocation.buffer, allocation.offset);
+    return *this;
+}
+
+void
+binding_point::bind(const data_buffer& buffer, GLintptr offset) const {
+    glVertexArrayVertexBuffer(vao, binding, buffer.handle(), offset, stride);
+}
+
+vertex_array::vertex_array() : handle_(0), next_binding_point_(0), ibo_offset_(0) {
     glCreateVertexArrays(1, &handle_);
 }
 
@@ -33,8 +44,26 @@ vertex_array::release() {
 }
 
 void
-vertex_array::set_index_buffer(std::shared_ptr<const data_buffer> ibo) {
+vertex_array::set_index_buffer(std::shared_ptr<const data_buffer> ibo, GLintptr offset) {
     ibo_ = ibo;
+    ibo_offset_ = offset;
+}
+
+void
+vertex_array::set_index_buffer(const buffer_allocation& allocation) {
+    set_index_buffer(allocation.buffer, allocation.offset);
+}
+
+GLintptr
+vertex_array::index_offset() const {
+    return ibo_offset_;
+}
+
+void
+vertex_array::draw_elements(GLenum mode, GLsizei count, GLenum index_type, GLuint first_index, GLint base_vertex, GLsizei instances) const {
+    GLintptr index_size = index_type == GL_UNSIGNED_BYTE ? 1 : (index_type == GL_UNSIGNED_SHORT ? 2 : 4);
+    const void* indices = reinterpret_cast<const void*>(ibo_offset_ + first_index * index_size);
+    glDrawElementsInstancedBaseVertex(mode, count, index_type, indices, instances, base_vertex);
 }
 
 binding_point
@@ -0,0 +1,452 @@
+#include <virtual_texture.hpp>
+#include <texture_file.hpp>
+
+#include <cstring>
+
+namespace baldr {
+
+namespace {
+
+// feedback readbacks in flight before frames are skipped
+constexpr size_t max_feedback_reads = 3;
+
+// bounds the CPU page table mirrors to about 40 MB
+constexpr int32_t max_tiles_per_side = 2048;
+
+constexpr uint32_t
+tile_key(uint32_t level, uint32_t x, uint32_t y) {
+    return (level << 28) | (y << 14) | x;
+}
+
+constexpr virtual_tile
+key_tile(uint32_t key) {
+    return {key >> 28, key & 0x3fff, (key >> 14) & 0x3fff};
+}
+
+size_t
+component_bytes(GLenum pixel_type) {
+    switch (pixel_type) {
+        case GL_UNSIGNED_BYTE: case GL_BYTE:
+            return 1;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+bool
+power_of_two(int32_t value) {
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+}  // namespace
+
+virtual_texture::virtual_texture(const virtual_texture_specification& specs, tile_provider provider, uint32_t worker_count) : specs_(specs), provider_(std::move(provider)), phase_(0), epoch_(0), stop_(false) {
+    terminate_unless(specs.width % specs.tile_size == 0 && specs.height % specs.tile_size == 0
+        && power_of_two(specs.width / specs.tile_size) && power_of_two(specs.height / specs.tile_size),
+        "Virtual texture size {}x{} is not a power of two multiple of the tile size {}", specs.width, specs.height, specs.tile_size);
+    terminate_unless(specs.atlas_tiles > 1 && specs.atlas_tiles <= 256, "Virtual texture atlas must hold between 2x2 and 256x256 tiles");
+    terminate_unless(specs.feedback_rate > 0, "Virtual texture feedback rate must be positive");
+
+    int32_t max_tiles = std::max(specs.width, specs.height) / specs.tile_size;
+    terminate_unless(max_tiles <= max_tiles_per_side, "Virtual texture exceeds {} tiles per side", max_tiles_per_side);
+    levels_ = 1;
+    while ((1 << (levels_ - 1)) < max_tiles) {
+        ++levels_;
+    }
+
+    int32_t padded = specs.tile_size + 2 * specs.border;
+    tile_bytes_ = static_cast<size_t>(padded * padded) * detail::channel_count(specs.format) * component_bytes(specs.pixel_type);
+
+    int32_t atlas_size = specs.atlas_tiles * padded;
+    texture_specification atlas_specs{specs.format, specs.internal_format};
+    atlas_specs.filter = {GL_LINEAR, GL_LINEAR};
+    atlas_ = std::make_unique<texture>(atlas_size, atlas_size, atlas_specs);
+    atlas_->tag("virtual_texture");
+
+    vec2i_t tiles = level_tiles(0);
+    texture_specification table_specs{GL_RGBA_INTEGER, GL_RGBA8UI};
+    table_specs.levels = static_cast<GLuint>(levels_);
+    page_table_ = std::make_unique<texture>(tiles[0], tiles[1], table_specs);
+    page_table_->tag("virtual_texture");
+
+    feedback_ = std::make_unique<data_buffer>((specs.feedback_capacity + 1) * sizeof(uint32_t), immutable_storage(GL_DYNAMIC_STORAGE_BIT));
+    feedback_->clear_to_zero();
+    feedback_->tag("virtual_texture");
+
+    for (int level = 0; level < levels_; ++level) {
+        vec2i_t size = level_tiles(level);
+        resident_.emplace_back(size[0] * size[1], 0);
+        table_.emplace_back(size[0] * size[1] * 4, 0);
+        dirty_.emplace_back();
+        page_table_->set(table_.back().data(), page_table_->level_region(level), level);
+    }
+
+    uint32_t slot_count = static_cast<uint32_t>(specs.atlas_tiles * specs.atlas_tiles);
+    for (uint32_t slot = slot_count; slot > 0; --slot) {
+        free_slots_.push_back(slot - 1);
+    }
+    stats_.capacity = slot_count;
+
+    for (uint32_t i = 0; i < std::max(worker_count, 1u); ++i) {
+        workers_.emplace_back([this] () { work_(); });
+    }
+
+    // the coarsest tile is loaded upfront and pinned
+    root_ = tile_key(levels_ - 1, 0, 0);
+    pending_.insert(root_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_.push_back(root_);
+    }
+    work_available_.notify_one();
+}
+
+virtual_texture::~virtual_texture() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+virtual_texture::tile_provider
+virtual_texture::file_provider(const std::filesystem::path& path, const virtual_texture_specification& specs) {
+    auto file = std::make_shared<mapped_file>(path);
+
+    // byte offset of the first tile per level
+    int32_t tiles_x = specs.width / specs.tile_size;
+    int32_t tiles_y = specs.height / specs.tile_size;
+    int32_t padded = specs.tile_size + 2 * specs.border;
+    size_t tile_bytes = static_cast<size_t>(padded * padded) * detail::channel_count(specs.format) * component_bytes(specs.pixel_type);
+    std::vector<size_t> offsets(1, 0);
+    std::vector<uint32_t> row_tiles;
+    for (;;) {
+        row_tiles.push_back(static_cast<uint32_t>(tiles_x));
+        offsets.push_back(offsets.back() + static_cast<size_t>(tiles_x * tiles_y) * tile_bytes);
+        if (tiles_x == 1 && tiles_y == 1) break;
+        tiles_x = std::max(1, tiles_x / 2);
+        tiles_y = std::max(1, tiles_y / 2);
+    }
+    terminate_unless(file->size() >= offsets.back(), "Tile file \"{}\" is too small ({} of {} bytes)", path.string(), file->size(), offsets.back());
+
+    return [file, offsets, row_tiles, tile_bytes] (const virtual_tile& tile, std::span<std::byte> pixels) {
+        if (tile.level >= row_tiles.size() || pixels.size() < tile_bytes) {
+            return false;
+        }
+        size_t offset = offsets[tile.level] + (static_cast<size_t>(tile.y) * row_tiles[tile.level] + tile.x) * tile_bytes;
+        if (offset + tile_bytes > offsets[tile.level + 1]) {
+            return false;
+        }
+        std::memcpy(pixels.data(), file->data().data() + offset, tile_bytes);
+        return true;
+    };
+}
+
+const virtual_texture_specification&
+virtual_texture::specification() const {
+    return specs_;
+}
+
+int
+virtual_texture::level_count() const {
+    return levels_;
+}
+
+vec2i_t
+virtual_texture::level_tiles(int level) const {
+    return vec2i_t(
+        std::max(1, (specs_.width / specs_.tile_size) >> level),
+        std::max(1, (specs_.height / specs_.tile_size) >> level));
+}
+
+size_t
+virtual_texture::tile_byte_count() const {
+    return tile_bytes_;
+}
+
+const texture&
+virtual_texture::atlas() const {
+    return *atlas_;
+}
+
+const texture&
+virtual_texture::page_table() const {
+    return *page_table_;
+}
+
+bool
+virtual_texture::ready() const {
+    return cache_.contains(root_);
+}
+
+bool
+virtual_texture::resident(const virtual_tile& tile) const {
+    return cache_.contains(tile_key(tile.level, tile.x, tile.y));
+}
+
+std::string
+virtual_texture::glsl_declaration(const std::string& name) const {
+    // page table entries hold the atlas slot (rg), the level of the tile
+    // actually resident (b) and a valid flag (a)
+    return fmt::format(
+        "uniform usampler2D {0}_page_table;\n"
+        "uniform sampler2D {0}_atlas;\n"
+        "uniform int {0}_feedback_phase;\n"
+        "layout(std430) buffer {0}_feedback {{ uint {0}_request_count; uint {0}_requests[]; }};\n"
+        "vec4 {0}(vec2 uv) {{\n"
+        "    const vec2 virtual_size = vec2({1}.0, {2}.0);\n"
+        "    const float tile_size = {3}.0;\n"
+        "    vec2 texel = fract(uv) * virtual_size;\n"
+        "    vec2 dx = dFdx(uv * virtual_size);\n"
+        "    vec2 dy = dFdy(uv * virtual_size);\n"
+        "    float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8));\n"
+        "    int level = clamp(int(floor(lod)), 0, {4});\n"
+        "    ivec2 tile = min(ivec2(texel / (tile_size * exp2(float(level)))), textureSize({0}_page_table, level) - 1);\n"
+        "    ivec2 pixel = ivec2(gl_FragCoord.xy) % {5};\n"
+        "    if (pixel.x + pixel.y * {5} == {0}_feedback_phase) {{\n"
+        "        uint index = atomicAdd({0}_request_count, 1u);\n"
+        "        if (index < {6}u) {{\n"
+        "            {0}_requests[index] = (uint(level) << 28) | (uint(tile.y) << 14) | uint(tile.x);\n"
+        "        }}\n"
+        "    }}\n"
+        "    uvec4 entry = texelFetch({0}_page_table, tile, level);\n"
+        "    if (entry.a == 0u) return vec4(0.0);\n"
+        "    vec2 in_tile = fract(texel / (tile_size * exp2(float(entry.b))));\n"
+        "    vec2 atlas_texel = vec2(entry.rg) * {7}.0 + {8}.0 + in_tile * tile_size;\n"
+        "    return textureLod({0}_atlas, atlas_texel / {9}.0, 0.0);\n"
+        "}}\n",
+        name, specs_.width, specs_.height, specs_.tile_size, levels_ - 1, specs_.feedback_rate, specs_.feedback_capacity,
+        specs_.tile_size + 2 * specs_.border, specs_.border, atlas_->width());
+}
+
+void
+virtual_texture::bind(const shader_program& program, const std::string& name) const {
+    program.sampler(name + "_page_table") = *page_table_;
+    program.sampler(name + "_atlas") = *atlas_;
+    program.ssbo(name + "_feedback") = *feedback_;
+    program.uniform(name + "_feedback_phase") = static_cast<int>(phase_);
+}
+
+void
+virtual_texture::update(uint32_t max_uploads) {
+    while (!feedback_reads_.empty() && feedback_reads_.front().ready()) {
+        process_feedback_(feedback_reads_.front().values<uint32_t>());
+        feedback_reads_.pop_front();
+    }
+
+    // make this frame's shader writes visible to the copy and the reset
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    if (feedback_reads_.size() < max_feedback_reads) {
+        feedback_reads_.push_back(feedback_->read_async());
+    }
+    feedback_->clear_to_zero(0, sizeof(uint32_t));
+
+    upload_tiles_(max_uploads);
+    update_page_table_();
+
+    // sample a different pixel of each feedback_rate^2 block next frame
+    phase_ = (phase_ + 1) % (specs_.feedback_rate * specs_.feedback_rate);
+}
+
+virtual_texture_statistics
+virtual_texture::statistics() const {
+    virtual_texture_statistics stats = stats_;
+    stats.resident = cache_.size();
+    stats.pending = pending_.size();
+    return stats;
+}
+
+void
+virtual_texture::work_() {
+    for (;;) {
+        uint32_t key;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] () { return stop_ || !requests_.empty(); });
+            if (stop_) return;
+            key = requests_.front();
+            requests_.pop_front();
+        }
+
+        loaded_tile tile{key, std::vector<std::byte>(tile_bytes_), false};
+        tile.valid = provider_(key_tile(key), tile.pixels);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        loaded_.push_back(std::move(tile));
+    }
+}
+
+bool
+virtual_texture::valid_key_(uint32_t key) const {
+    virtual_tile tile = key_tile(key);
+    if (tile.level >= static_cast<uint32_t>(levels_)) {
+        return false;
+    }
+    vec2i_t tiles = level_tiles(tile.level);
+    return tile.x < static_cast<uint32_t>(tiles[0]) && tile.y < static_cast<uint32_t>(tiles[1]);
+}
+
+bool
+virtual_texture::touch_(uint32_t key) {
+    auto it = cache_.find(key);
+    if (it == cache_.end()) {
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    it->second.last_used = epoch_;
+    return true;
+}
+
+void
+virtual_texture::process_feedback_(std::span<const uint32_t> requests) {
+    if (requests.empty()) return;
+    uint32_t count = std::min<uint32_t>(requests[0], static_cast<uint32_t>(requests.size() - 1));
+    std::unordered_set<uint32_t> requested(requests.begin() + 1, requests.begin() + 1 + count);
+    ++epoch_;
+
+    std::vector<uint32_t> loads;
+    for (uint32_t key : requested) {
+        if (!valid_key_(key)) continue;
+        ++stats_.requests;
+        if (touch_(key)) continue;
+        ++stats_.misses;
+
+        // missing ancestors are loaded as well to refine the fallback step by step
+        for (uint32_t k = key;;) {
+            if (touch_(k)) break;
+            if (pending_.insert(k).second) {
+                loads.push_back(k);
+            }
+            virtual_tile tile = key_tile(k);
+            if (static_cast<int>(tile.level) + 1 >= levels_) break;
+            k = tile_key(tile.level + 1, tile.x / 2, tile.y / 2);
+        }
+    }
+    if (loads.empty()) return;
+
+    // coarse tiles first since they cover the most misses
+    std::sort(loads.begin(), loads.end(), [] (uint32_t a, uint32_t b) { return (a >> 28) > (b >> 28); });
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_.insert(requests_.end(), loads.begin(), loads.end());
+    }
+    work_available_.notify_all();
+}
+
+void
+virtual_texture::upload_tiles_(uint32_t max_uploads) {
+    std::vector<loaded_tile> tiles;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!loaded_.empty() && tiles.size() < max_uploads) {
+            tiles.push_back(std::move(loaded_.front()));
+            loaded_.pop_front();
+        }
+    }
+
+    int32_t padded = specs_.tile_size + 2 * specs_.border;
+    for (auto& tile : tiles) {
+        pending_.erase(tile.key);
+        if (!tile.valid) {
+            ++stats_.failures;
+            continue;
+        }
+
+        // without a free slot the tile is dropped and requested again by
+        // the feedback of later frames
+        auto slot = allocate_slot_();
+        if (!slot) continue;
+
+        texture_region region{
+            vec3i_t(static_cast<int32_t>(*slot) % specs_.atlas_tiles * padded, static_cast<int32_t>(*slot) / specs_.atlas_tiles * padded, 0),
+            vec3i_t(padded, padded, 1)
+        };
+        atlas_->set(tile.pixels.data(), specs_.pixel_type, region);
+
+        lru_.push_front(tile.key);
+        cache_[tile.key] = {*slot, lru_.begin(), epoch_};
+        virtual_tile t = key_tile(tile.key);
+        resident_[t.level][t.y * level_tiles(t.level)[0] + t.x] = *slot + 1;
+        mark_dirty_(t);
+        ++stats_.loads;
+    }
+}
+
+std::optional<uint32_t>
+virtual_texture::allocate_slot_() {
+    if (!free_slots_.empty()) {
+        uint32_t slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+
+    for (auto it = lru_.rbegin(); it != lru_.rend(); ++it) {
+        if (*it == root_) continue;
+        auto entry = cache_.find(*it);
+        // everything further to the front has been used at least as recently
+        if (entry->second.last_used >= epoch_) break;
+
+        uint32_t slot = entry->second.slot;
+        virtual_tile t = key_tile(*it);
+        resident_[t.level][t.y * level_tiles(t.level)[0] + t.x] = 0;
+        mark_dirty_(t);
+        lru_.erase(entry->second.lru);
+        cache_.erase(entry);
+        ++stats_.evictions;
+        return slot;
+    }
+    return std::nullopt;
+}
+
+void
+virtual_texture::mark_dirty_(const virtual_tile& tile) {
+    for (int level = static_cast<int>(tile.level); level >= 0; --level) {
+        int shift = static_cast<int>(tile.level) - level;
+        vec2i_t size = level_tiles(level);
+        vec3i_t lower(static_cast<int32_t>(tile.x) << shift, static_cast<int32_t>(tile.y) << shift, 0);
+        vec3i_t upper(std::min(static_cast<int32_t>(tile.x + 1) << shift, size[0]), std::min(static_cast<int32_t>(tile.y + 1) << shift, size[1]), 1);
+        dirty_[level].add(lower, upper - lower);
+    }
+}
+
+void
+virtual_texture::update_page_table_() {
+    uint32_t atlas_tiles = static_cast<uint32_t>(specs_.atlas_tiles);
+    // coarse levels first, finer entries fall back to their parents
+    for (int level = levels_ - 1; level >= 0; --level) {
+        if (dirty_[level].empty()) continue;
+
+        vec2i_t size = level_tiles(level);
+        vec2i_t parent_size = level + 1 < levels_ ? level_tiles(level + 1) : vec2i_t(0, 0);
+        auto& entries = table_[level];
+        for (const auto& region : dirty_[level].regions()) {
+            const auto& [offset, extent] = region;
+            for (int32_t y = offset[1]; y < offset[1] + extent[1]; ++y) {
+                for (int32_t x = offset[0]; x < offset[0] + extent[0]; ++x) {
+                    uint8_t* entry = &entries[(y * size[0] + x) * 4];
+                    if (uint32_t slot = resident_[level][y * size[0] + x]) {
+                        entry[0] = static_cast<uint8_t>((slot - 1) % atlas_tiles);
+                        entry[1] = static_cast<uint8_t>((slot - 1) / atlas_tiles);
+                        entry[2] = static_cast<uint8_t>(level);
+                        entry[3] = 1;
+                    } else if (parent_size[0]) {
+                        int32_t px = std::min(x / 2, parent_size[0] - 1);
+                        int32_t py = std::min(y / 2, parent_size[1] - 1);
+                        std::memcpy(entry, &table_[level + 1][(py * parent_size[0] + px) * 4], 4);
+                    } else {
+                        std::memset(entry, 0, 4);
+                    }
+                }
+            }
+            page_table_->set(&entries[(offset[1] * size[0] + offset[0]) * 4], region, level, size[0]);
+        }
+        dirty_[level].clear();
+    }
+}
+
+} // baldr